@@ -1,17 +1,19 @@
-QT += widgets core5compat core gui network
-CONFIG += static
+QT += widgets core5compat core gui network concurrent
 TARGET = PawniX
 TEMPLATE = app
-QMAKE_LFLAGS += -static -static-libgcc -static-libstdc++
-
-LIBS += -L"C:/Qt/6.9.1/mingw_64/lib" \
-        -lQt6Core5Compat \
-        -lQt6Core \
-        -lQt6Gui \
-        -lQt6Widgets \
-        -lQt6Network
 
 win32 {
+    CONFIG += static
+    QMAKE_LFLAGS += -static -static-libgcc -static-libstdc++
+
+    LIBS += -L"C:/Qt/6.9.1/mingw_64/lib" \
+            -lQt6Core5Compat \
+            -lQt6Core \
+            -lQt6Gui \
+            -lQt6Widgets \
+            -lQt6Network \
+            -lQt6Concurrent
+
     QMAKE_CXXFLAGS += -finput-charset=UTF-8 -fexec-charset=UTF-8
     DEFINES += _WIN32_WINNT=0x0601
 }
@@ -19,4 +21,21 @@ win32 {
 SOURCES += main.cpp
 RESOURCES += icons.qrc
 RC_FILE = app.rc
-HEADERS += includes.h
+HEADERS += includes.h \
+           buildpipeline.h \
+           sourcefile.h \
+           pawnlexer.h \
+           symbolindex.h \
+           headless.h \
+           codeeditor.h \
+           trace.h \
+           settingsstore.h \
+           analysis.h \
+           preprocessor.h \
+           workspaceindex.h \
+           refactoring.h \
+           lint.h \
+           amx.h \
+           profile.h \
+           servertarget.h \
+           gitdiff.h
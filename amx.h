@@ -0,0 +1,205 @@
+#ifndef AMX_H
+#define AMX_H
+
+#include "includes.h"
+#include "buildpipeline.h"
+
+struct AmxInfo {
+    bool valid = false;
+    QString error;
+    qint64 fileSize = 0;
+    int fileVersion = 0;
+    int amxVersion = 0;
+    int flags = 0;
+    int cellSize = 4;
+    qint64 codeSize = 0;
+    qint64 dataSize = 0;
+    qint64 stackHeapSize = 0;
+    QStringList publics;
+    QStringList natives;
+    QStringList libraries;
+    QStringList pubvars;
+    QStringList tags;
+    QHash<QString, int> functionSizes;
+
+    bool isCompact() const { return flags & 0x04; }
+    bool hasDebugInfo() const { return flags & 0x02; }
+    qint64 memorySize() const { return codeSize + dataSize + stackHeapSize; }
+    QString summary(const AmxInfo& previous) const {
+        QString text = QString("AMX: код %1, данные %2, стек/куча %3, файл %4; publics %5, natives %6")
+                           .arg(sizeDelta(codeSize, previous.codeSize, previous.valid))
+                           .arg(sizeDelta(dataSize, previous.dataSize, previous.valid))
+                           .arg(sizeDelta(stackHeapSize, previous.stackHeapSize, previous.valid))
+                           .arg(sizeDelta(fileSize, previous.fileSize, previous.valid))
+                           .arg(publics.size()).arg(natives.size());
+        if (!previous.valid) return text;
+        QStringList added;
+        QStringList removed;
+        for (const QString& name : natives) {
+            if (!previous.natives.contains(name)) added << name;
+        }
+        for (const QString& name : previous.natives) {
+            if (!natives.contains(name)) removed << name;
+        }
+        if (!added.isEmpty()) text += "\nНовые natives: " + added.join(", ");
+        if (!removed.isEmpty()) text += "\nУдалённые natives: " + removed.join(", ");
+        return text;
+    }
+    static QString sizeDelta(qint64 current, qint64 previous, bool hasPrevious) {
+        QString text = QString::number(current) + " Б";
+        if (hasPrevious && current != previous) {
+            text += QString(" (%1%2)").arg(current > previous ? "+" : "").arg(current - previous);
+        }
+        return text;
+    }
+
+    static AmxInfo read(const QString& path) {
+        AmxInfo info;
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) {
+            info.error = file.errorString();
+            return info;
+        }
+        return parse(file.readAll());
+    }
+    static AmxInfo parse(const QByteArray& data) {
+        AmxInfo info;
+        if (data.size() < headerSize) {
+            info.error = "файл меньше заголовка AMX";
+            return info;
+        }
+        auto u16 = [&data](int offset) { return qFromLittleEndian<quint16>(data.constData() + offset); };
+        auto i32 = [&data](int offset) { return qFromLittleEndian<qint32>(data.constData() + offset); };
+        quint16 magic = u16(4);
+        if (magic == 0xF1E0) info.cellSize = 4;
+        else if (magic == 0xF1E1) info.cellSize = 8;
+        else if (magic == 0xF1E2) info.cellSize = 2;
+        else {
+            info.error = QString("неизвестная сигнатура 0x%1").arg(magic, 4, 16, QChar('0'));
+            return info;
+        }
+        info.fileSize = data.size();
+        info.fileVersion = quint8(data[6]);
+        info.amxVersion = quint8(data[7]);
+        info.flags = u16(8);
+        int definitionSize = u16(10);
+        qint32 cod = i32(12);
+        qint32 dat = i32(16);
+        qint32 hea = i32(20);
+        qint32 stp = i32(24);
+        if (definitionSize < 4 || cod < headerSize || cod > data.size() || dat < cod || hea < dat || stp < hea) {
+            info.error = "повреждённый заголовок AMX";
+            return info;
+        }
+        info.codeSize = dat - cod;
+        info.dataSize = hea - dat;
+        info.stackHeapSize = stp - hea;
+        qint32 tables[] = { i32(32), i32(36), i32(40), i32(44), i32(48), i32(52) };
+        QStringList* lists[] = { &info.publics, &info.natives, &info.libraries, &info.pubvars, &info.tags };
+        for (int i = 0; i < 5; ++i) {
+            if (tables[i] < headerSize || tables[i] > data.size()) continue;
+            for (qint32 offset = tables[i]; offset + definitionSize <= tables[i + 1] && offset + definitionSize <= data.size();
+                 offset += definitionSize) {
+                QString name = entryName(data, offset, definitionSize);
+                if (!name.isEmpty()) *lists[i] << name;
+            }
+        }
+        info.valid = true;
+        return info;
+    }
+    QJsonObject toJson() const {
+        QJsonObject object;
+        object["fileSize"] = fileSize;
+        object["codeSize"] = codeSize;
+        object["dataSize"] = dataSize;
+        object["stackHeapSize"] = stackHeapSize;
+        object["cellSize"] = cellSize;
+        object["compact"] = isCompact();
+        object["debugInfo"] = hasDebugInfo();
+        object["publics"] = QJsonArray::fromStringList(publics);
+        object["natives"] = QJsonArray::fromStringList(natives);
+        QJsonObject functions;
+        for (auto it = functionSizes.constBegin(); it != functionSizes.constEnd(); ++it) {
+            functions[it.key()] = it.value();
+        }
+        object["functions"] = functions;
+        return object;
+    }
+    static AmxInfo fromJson(const QJsonObject& object) {
+        AmxInfo info;
+        info.valid = !object.isEmpty();
+        info.fileSize = object["fileSize"].toInteger();
+        info.codeSize = object["codeSize"].toInteger();
+        info.dataSize = object["dataSize"].toInteger();
+        info.stackHeapSize = object["stackHeapSize"].toInteger();
+        info.cellSize = object["cellSize"].toInt(4);
+        for (const QJsonValue& name : object["publics"].toArray()) info.publics << name.toString();
+        for (const QJsonValue& name : object["natives"].toArray()) info.natives << name.toString();
+        QJsonObject functions = object["functions"].toObject();
+        for (auto it = functions.constBegin(); it != functions.constEnd(); ++it) {
+            info.functionSizes.insert(it.key(), it.value().toInt());
+        }
+        return info;
+    }
+private:
+    static constexpr int headerSize = 56;
+
+    static QString entryName(const QByteArray& data, int offset, int definitionSize) {
+        if (definitionSize == 8) {
+            qint32 nameOffset = qFromLittleEndian<qint32>(data.constData() + offset + 4);
+            if (nameOffset < headerSize || nameOffset >= data.size()) return QString();
+            return QString::fromLatin1(data.constData() + nameOffset);
+        }
+        return QString::fromLatin1(data.mid(offset + 4, definitionSize - 4).constData());
+    }
+};
+
+class AmxListing {
+public:
+    static CompileRequest requestFor(const CompileRequest& build) {
+        CompileRequest request = build;
+        request.extraArguments << "-a";
+        request.outputFile = QDir::temp().filePath(QString("pawnix-%1-%2.asm")
+                                                       .arg(QFileInfo(build.sourceFile).baseName())
+                                                       .arg(QCoreApplication::applicationPid()));
+        return request;
+    }
+    static QHash<QString, int> read(const QString& path, int cellSize = 4) {
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) return QHash<QString, int>();
+        QString listing = QString::fromLocal8Bit(file.readAll());
+        file.close();
+        file.remove();
+        return functionSizes(listing, cellSize);
+    }
+    static QHash<QString, int> functionSizes(const QString& listing, int cellSize = 4) {
+        static const QRegularExpression whitespace("\\s+");
+        QHash<QString, int> sizes;
+        QString function;
+        bool code = true;
+        for (const QString& rawLine : listing.split('\n')) {
+            QString line = rawLine.trimmed();
+            int comment = line.indexOf(';');
+            QString instruction = (comment >= 0 ? line.left(comment) : line).trimmed();
+            if (instruction.isEmpty()) continue;
+            QStringList parts = instruction.split(whitespace);
+            const QString& opcode = parts.first();
+            if (opcode == "CODE") {
+                code = true;
+                continue;
+            }
+            if (opcode == "DATA" || opcode == "STKSIZE") {
+                code = false;
+                continue;
+            }
+            if (!code || opcode.startsWith("l.")) continue;
+            if (opcode == "proc") function = comment >= 0 ? line.mid(comment + 1).trimmed() : QString();
+            if (function.isEmpty()) continue;
+            int cells = opcode == "case" ? parts.size() - 1 : parts.size();
+            sizes[function] += cells * cellSize;
+        }
+        return sizes;
+    }
+};
+
+#endif
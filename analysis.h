@@ -0,0 +1,232 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "includes.h"
+#include "symbolindex.h"
+#include "preprocessor.h"
+#include "buildpipeline.h"
+#include "lint.h"
+#include "trace.h"
+
+struct DocumentSnapshot {
+    quintptr documentId = 0;
+    int revision = 0;
+    QString filePath;
+    QString text;
+};
+
+struct AnalysisResult {
+    quintptr documentId = 0;
+    int revision = 0;
+    QString filePath;
+    QList<SymbolInfo> symbols;
+    FileReferences references;
+    QHash<QString, MacroTable> includeMacros;
+    SemanticTable semanticKinds;
+    LintReport lint;
+    qint64 elapsedNs = 0;
+};
+
+class IncludeResolver {
+public:
+    void resolve(const DocumentSnapshot& snapshot, AnalysisResult& result) {
+        resolve(snapshot, result, snapshot.filePath.isEmpty() ? QStringList()
+                                                              : CompileRequest::forSource(QString(), snapshot.filePath).includeDirs);
+    }
+    void resolve(const DocumentSnapshot& snapshot, AnalysisResult& result, const QStringList& includeDirs) {
+        result.includeMacros.clear();
+        result.semanticKinds.clear();
+        if (!snapshot.filePath.isEmpty()) {
+            QString fromDir = QFileInfo(snapshot.filePath).absolutePath();
+            QSet<QString> visited;
+            for (const auto& include : IncludeGraph::parseIncludeLines(snapshot.text.toLatin1())) {
+                QString path = IncludeGraph::resolve(include.first, fromDir, includeDirs);
+                if (path.isEmpty() || result.includeMacros.contains(include.first)) continue;
+                MacroTable table;
+                for (const QString& file : graph.closure(path, includeDirs)) {
+                    const Entry& entry = entryOf(file);
+                    for (const MacroDefinition& macro : entry.macros) {
+                        table.insert(macro.name, macro);
+                    }
+                    if (visited.contains(file)) continue;
+                    visited.insert(file);
+                    for (const SymbolInfo& symbol : entry.symbols) {
+                        result.semanticKinds.insert(symbol.name, symbol.kind);
+                    }
+                }
+                result.includeMacros.insert(include.first, table);
+            }
+        }
+        for (const SymbolInfo& symbol : result.symbols) {
+            result.semanticKinds.insert(symbol.name, symbol.kind);
+        }
+    }
+private:
+    struct Entry {
+        qint64 size = -1;
+        QDateTime modified;
+        MacroTable macros;
+        QList<SymbolInfo> symbols;
+    };
+    IncludeGraph graph;
+    QHash<QString, Entry> cache;
+    const Entry& entryOf(const QString& file) {
+        QFileInfo info(file);
+        Entry& entry = cache[file];
+        if (entry.size != info.size() || entry.modified != info.lastModified()) {
+            entry.size = info.size();
+            entry.modified = info.lastModified();
+            QString text;
+            if (SourceFile::read(file, text)) {
+                entry.macros = PreprocessorModel::collectMacros(text);
+                entry.symbols = SymbolParser::parse(text, file);
+            } else {
+                entry.macros.clear();
+                entry.symbols.clear();
+            }
+        }
+        return entry;
+    }
+};
+
+class AnalysisService : public QObject {
+    Q_OBJECT
+public:
+    using Pass = std::function<void(const DocumentSnapshot&, AnalysisResult&)>;
+    AnalysisService(QObject* parent = nullptr) : QObject(parent) {
+        pool.setMaxThreadCount(1);
+        addPass([](const DocumentSnapshot& snapshot, AnalysisResult& result) {
+            result.symbols = SymbolParser::parse(snapshot.text, snapshot.filePath);
+            result.references = ReferenceIndex::scan(snapshot.text);
+        });
+        addPass([resolver = std::make_shared<IncludeResolver>()](const DocumentSnapshot& snapshot, AnalysisResult& result) {
+            resolver->resolve(snapshot, result);
+        });
+        addPass([registry = std::make_shared<LintRegistry>(LintRegistry::defaults())](const DocumentSnapshot& snapshot, AnalysisResult& result) {
+            result.lint = registry->run(snapshot.filePath, snapshot.text, result.symbols, result.includeMacros);
+        });
+    }
+    ~AnalysisService() {
+        {
+            QMutexLocker locker(&mutex);
+            pending.clear();
+        }
+        pool.clear();
+        pool.waitForDone();
+    }
+    void addPass(const Pass& pass) {
+        QMutexLocker locker(&mutex);
+        passes.append(pass);
+    }
+    void watch(QTextDocument* document, const QString& filePath) {
+        quintptr id = reinterpret_cast<quintptr>(document);
+        if (watched.contains(id)) {
+            setFilePath(document, filePath);
+            return;
+        }
+        QTimer* timer = new QTimer(this);
+        timer->setSingleShot(true);
+        timer->setInterval(250);
+        watched.insert(id, Watched { document, filePath, timer });
+        connect(timer, &QTimer::timeout, this, [this, id]() { takeSnapshot(id); });
+        connect(document, &QTextDocument::contentsChanged, timer, QOverload<>::of(&QTimer::start));
+        connect(document, &QObject::destroyed, this, [this, id]() { unwatch(id); });
+        takeSnapshot(id);
+    }
+    void setFilePath(QTextDocument* document, const QString& filePath) {
+        quintptr id = reinterpret_cast<quintptr>(document);
+        auto it = watched.find(id);
+        if (it == watched.end() || it->filePath == filePath) return;
+        it->filePath = filePath;
+        takeSnapshot(id);
+    }
+    void refresh(QTextDocument* document) {
+        takeSnapshot(reinterpret_cast<quintptr>(document));
+    }
+    bool hasResult(QTextDocument* document) const {
+        return results.contains(reinterpret_cast<quintptr>(document));
+    }
+    AnalysisResult result(QTextDocument* document) const {
+        return results.value(reinterpret_cast<quintptr>(document));
+    }
+    void submit(DocumentSnapshot snapshot) {
+        snapshot.revision = ++revisionCounter;
+        latestRevision.insert(snapshot.documentId, snapshot.revision);
+        {
+            QMutexLocker locker(&mutex);
+            pending.insert(snapshot.documentId, snapshot);
+        }
+        quintptr id = snapshot.documentId;
+        pool.start([this, id]() { analyze(id); });
+    }
+signals:
+    void resultReady(const AnalysisResult& result);
+private:
+    struct Watched {
+        QPointer<QTextDocument> document;
+        QString filePath;
+        QTimer* timer;
+    };
+    QHash<quintptr, Watched> watched;
+    QHash<quintptr, int> latestRevision;
+    int revisionCounter = 0;
+    QHash<quintptr, AnalysisResult> results;
+    QMutex mutex;
+    QHash<quintptr, DocumentSnapshot> pending;
+    QList<Pass> passes;
+    QThreadPool pool;
+
+    void takeSnapshot(quintptr id) {
+        auto it = watched.find(id);
+        if (it == watched.end() || !it->document) return;
+        PAWNIX_TRACE("takeSnapshot", "analysis");
+        it->timer->stop();
+        DocumentSnapshot snapshot;
+        snapshot.documentId = id;
+        snapshot.filePath = it->filePath;
+        snapshot.text = it->document->toPlainText();
+        submit(snapshot);
+    }
+    void unwatch(quintptr id) {
+        auto it = watched.find(id);
+        if (it == watched.end()) return;
+        it->timer->deleteLater();
+        watched.erase(it);
+        latestRevision.remove(id);
+        results.remove(id);
+        QMutexLocker locker(&mutex);
+        pending.remove(id);
+    }
+    void analyze(quintptr id) {
+        DocumentSnapshot snapshot;
+        QList<Pass> runPasses;
+        {
+            QMutexLocker locker(&mutex);
+            auto it = pending.find(id);
+            if (it == pending.end()) return;
+            snapshot = it.value();
+            pending.erase(it);
+            runPasses = passes;
+        }
+        PAWNIX_TRACE("analyze", "analysis");
+        QElapsedTimer timer;
+        timer.start();
+        AnalysisResult result;
+        result.documentId = snapshot.documentId;
+        result.revision = snapshot.revision;
+        result.filePath = snapshot.filePath;
+        for (const Pass& pass : runPasses) {
+            pass(snapshot, result);
+        }
+        result.elapsedNs = timer.nsecsElapsed();
+        QMetaObject::invokeMethod(this, [this, result]() { publish(result); }, Qt::QueuedConnection);
+    }
+    void publish(const AnalysisResult& result) {
+        auto latest = latestRevision.constFind(result.documentId);
+        if (latest == latestRevision.constEnd() || result.revision < latest.value()) return;
+        results.insert(result.documentId, result);
+        emit resultReady(result);
+    }
+};
+
+#endif
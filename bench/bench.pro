@@ -0,0 +1,21 @@
+QT += widgets core5compat core gui concurrent
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = pawnix_bench
+TEMPLATE = app
+INCLUDEPATH += ..
+
+win32 {
+    QMAKE_CXXFLAGS += -finput-charset=UTF-8 -fexec-charset=UTF-8
+}
+
+SOURCES += main.cpp
+HEADERS += generators.h \
+           ../includes.h \
+           ../codeeditor.h \
+           ../sourcefile.h \
+           ../pawnlexer.h \
+           ../symbolindex.h \
+           ../buildpipeline.h \
+           ../trace.h \
+           ../preprocessor.h
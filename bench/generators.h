@@ -0,0 +1,116 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include "includes.h"
+
+class PawnGenerator {
+public:
+    static QString gamemode(int lineCount, int seed = 1) {
+        QRandomGenerator random(seed);
+        QString text;
+        text.reserve(lineCount * 40);
+        QTextStream out(&text);
+        int lines = 0;
+        auto emitLine = [&](const QString& line) {
+            out << line << '\n';
+            ++lines;
+        };
+        emitLine("#include <a_samp>");
+        emitLine("#include <streamer>");
+        emitLine("#define MAX_HOUSES (500)");
+        emitLine("#define COLOR_WHITE 0xFFFFFFFF");
+        emitLine("#if defined USE_MYSQL");
+        emitLine("    #include <a_mysql>");
+        emitLine("#endif");
+        emitLine("enum E_PLAYER_DATA {");
+        emitLine("    pName[MAX_PLAYER_NAME],");
+        emitLine("    Float:pHealth,");
+        emitLine("    pMoney");
+        emitLine("};");
+        emitLine("new PlayerData[MAX_PLAYERS][E_PLAYER_DATA];");
+        int function = 0;
+        while (lines < lineCount) {
+            int body = 10 + random.bounded(40);
+            QString name = QString("Function_%1").arg(function++);
+            switch (function % 4) {
+            case 0:
+                emitLine("forward " + name + "(playerid);");
+                emitLine("public " + name + "(playerid)");
+                break;
+            case 1:
+                emitLine("stock " + name + "(playerid, const message[])");
+                break;
+            case 2:
+                emitLine("stock Float:" + name + "(Float:x, Float:y)");
+                break;
+            default:
+                emitLine("/*");
+                emitLine(" * " + name + " handles a command");
+                emitLine(" */");
+                emitLine("CMD:" + name.toLower() + "(playerid, params[])");
+                break;
+            }
+            emitLine("{");
+            for (int i = 0; i < body && lines < lineCount; ++i) {
+                switch (random.bounded(8)) {
+                case 0:
+                    emitLine("    new string[128], value = " + QString::number(random.bounded(1000)) + ";");
+                    break;
+                case 1:
+                    emitLine("    format(string, sizeof(string), \"Player %d has %d money\", playerid, PlayerData[playerid][pMoney]);");
+                    break;
+                case 2:
+                    emitLine("    for (new i = 0; i < MAX_PLAYERS; i++) {");
+                    emitLine("        if (!IsPlayerConnected(i)) continue; // skip empty slots");
+                    emitLine("    }");
+                    break;
+                case 3:
+                    emitLine("    SendClientMessage(playerid, COLOR_WHITE, \"Hello from " + name + "\");");
+                    break;
+                case 4:
+                    emitLine("    #if defined DEBUG");
+                    emitLine("    printf(\"debug %d\", playerid);");
+                    emitLine("    #endif");
+                    break;
+                case 5:
+                    emitLine("    if (PlayerData[playerid][pHealth] < 10.0) return 0;");
+                    break;
+                case 6:
+                    emitLine("    Function_" + QString::number(random.bounded(qMax(1, function))) + "(playerid);");
+                    break;
+                default:
+                    emitLine("    switch (value) { case 1: value++; default: value--; }");
+                    break;
+                }
+            }
+            emitLine("    return 1;");
+            emitLine("}");
+        }
+        return text;
+    }
+    static QStringList includeTree(const QString& root, int fileCount, int linesPerFile) {
+        QDir().mkpath(root + "/include");
+        QStringList files;
+        for (int i = 0; i < fileCount; ++i) {
+            QString path = QString("%1/include/lib_%2.inc").arg(root).arg(i);
+            QString text;
+            for (int child = i * 2 + 1; child <= i * 2 + 2 && child < fileCount; ++child) {
+                text += QString("#include <lib_%1>\n").arg(child);
+            }
+            text += gamemode(linesPerFile, i + 1);
+            QFile file(path);
+            if (file.open(QFile::WriteOnly)) {
+                file.write(text.toLatin1());
+            }
+            files << path;
+        }
+        QFile main(root + "/main.pwn");
+        if (main.open(QFile::WriteOnly)) {
+            main.write("#include <lib_0>\nmain() {}\n");
+        }
+        files.prepend(root + "/main.pwn");
+        return files;
+    }
+};
+
+#endif
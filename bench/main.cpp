@@ -0,0 +1,201 @@
+#include "includes.h"
+#include "codeeditor.h"
+#include "sourcefile.h"
+#include "symbolindex.h"
+#include "buildpipeline.h"
+#include "generators.h"
+
+class Benchmark {
+public:
+    Benchmark(int iterationCount) : iterations(iterationCount) {}
+    template <typename Setup, typename Body>
+    void run(const QString& name, int lines, Setup setup, Body body) {
+        QList<double> samples;
+        for (int i = 0; i < iterations; ++i) {
+            setup();
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            samples.append(timer.nsecsElapsed() / 1000000.0);
+        }
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (double sample : samples) total += sample;
+        QJsonObject result;
+        result["name"] = name;
+        result["lines"] = lines;
+        result["iterations"] = iterations;
+        result["minMs"] = samples.first();
+        result["medianMs"] = samples[samples.size() / 2];
+        result["meanMs"] = total / samples.size();
+        result["maxMs"] = samples.last();
+        results.append(result);
+        QTextStream(stdout) << QString("%1 %2 lines: median %3 ms, min %4 ms\n")
+                                   .arg(name, -24).arg(lines, 7).arg(samples[samples.size() / 2], 0, 'f', 2)
+                                   .arg(samples.first(), 0, 'f', 2);
+    }
+    QJsonArray results;
+private:
+    int iterations;
+};
+
+static void runEditorBenchmarks(Benchmark& bench, int lines, const QString& workDir) {
+    QString text = PawnGenerator::gamemode(lines);
+    QString filePath = workDir + QString("/gamemode_%1.pwn").arg(lines);
+    QFile file(filePath);
+    if (file.open(QFile::WriteOnly)) {
+        file.write(SourceFile::encode(text));
+        file.close();
+    }
+
+    QTextDocument document;
+    PawnHighlighter* highlighter = new PawnHighlighter(&document);
+    document.setPlainText(text);
+    bench.run("highlight", lines, [] {}, [&] { highlighter->rehighlight(); });
+
+    CodeEditor editor;
+    editor.resize(1024, 768);
+    editor.show();
+    bench.run("loadFile", lines, [&] { editor.clear(); }, [&] {
+        QString content;
+        SourceFile::read(filePath, content);
+        editor.setPlainText(content);
+    });
+    bench.run("saveFile", lines, [] {}, [&] {
+        QFile out(filePath);
+        if (out.open(QFile::WriteOnly | QFile::Text)) {
+            out.write(SourceFile::encode(editor.toPlainText()));
+        }
+    });
+    bench.run("findText", lines, [] {}, [&] { editor.findText("SendClientMessage", true, false); });
+    bench.run("replaceText", lines, [&] { editor.setPlainText(text); }, [&] {
+        editor.replaceText("PlayerData", "gPlayerData", true, false);
+    });
+
+    editor.setPlainText(text);
+    QWidget* gutter = editor.lineNumberWidget();
+    bench.run("gutterPaint", lines, [&] {
+        editor.verticalScrollBar()->setValue(editor.verticalScrollBar()->maximum() / 2);
+    }, [&] { gutter->grab(); });
+
+    SymbolIndex index;
+    index.update(filePath, SymbolParser::parse(text, filePath));
+    QStringList words;
+    for (const QString& keyword : { "assert", "break", "case", "const", "continue", "default", "do", "else", "enum", "for",
+                                    "forward", "functag", "goto", "if", "native", "new", "operator", "public", "return",
+                                    "sizeof", "static", "stock", "switch", "tagof", "while", "defined" }) {
+        words << keyword;
+    }
+    for (const QString& name : index.files()) {
+        for (const SymbolInfo& symbol : index.symbolsInFile(name)) {
+            words << symbol.name;
+        }
+    }
+    QCompleter completer(words);
+    completer.setCaseSensitivity(Qt::CaseInsensitive);
+    completer.setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+    const QStringList prefixes { "s", "st", "Fun", "Function_1", "Player", "for", "zzz" };
+    bench.run("completion", lines, [] {}, [&] {
+        for (const QString& prefix : prefixes) {
+            completer.setCompletionPrefix(prefix);
+            completer.completionCount();
+            index.search(prefix, 50);
+        }
+    });
+}
+
+static void runIncludeTreeBenchmarks(Benchmark& bench, const QString& workDir, int fileCount, int linesPerFile) {
+    QString root = workDir + QString("/tree_%1").arg(fileCount);
+    QStringList files = PawnGenerator::includeTree(root, fileCount, linesPerFile);
+    int lines = fileCount * linesPerFile;
+    bench.run("includeClosure", lines, [] {}, [&] {
+        IncludeGraph graph;
+        graph.closure(files.first(), QStringList() << root + "/include");
+    });
+    bench.run("indexWorkspace", lines, [] {}, [&] {
+        SymbolIndex index;
+        index.indexFiles(files);
+    });
+}
+
+static int compare(const QString& baselinePath, const QString& currentPath, double threshold) {
+    auto load = [](const QString& path) {
+        QFile file(path);
+        QMap<QString, double> medians;
+        if (file.open(QFile::ReadOnly)) {
+            const QJsonArray results = QJsonDocument::fromJson(file.readAll()).object()["results"].toArray();
+            for (const QJsonValue& value : results) {
+                QJsonObject result = value.toObject();
+                medians.insert(result["name"].toString() + "/" + QString::number(result["lines"].toInt()),
+                               result["medianMs"].toDouble());
+            }
+        }
+        return medians;
+    };
+    QMap<QString, double> baseline = load(baselinePath);
+    QMap<QString, double> current = load(currentPath);
+    QTextStream out(stdout);
+    int regressions = 0;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (!baseline.contains(it.key())) continue;
+        double before = baseline.value(it.key());
+        double change = before > 0 ? (it.value() - before) / before * 100.0 : 0;
+        bool regressed = change > threshold;
+        if (regressed) ++regressions;
+        out << QString("%1 %2 ms -> %3 ms (%4%5%)%6\n")
+                   .arg(it.key(), -32).arg(before, 0, 'f', 2).arg(it.value(), 0, 'f', 2)
+                   .arg(change >= 0 ? "+" : "").arg(change, 0, 'f', 1)
+                   .arg(regressed ? "  REGRESSION" : "");
+    }
+    return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PawniX hot path benchmarks");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma separated gamemode sizes in lines.", "lines", "10000,100000,500000");
+    QCommandLineOption iterationsOption("iterations", "Iterations per benchmark.", "count", "5");
+    QCommandLineOption outputOption("output", "Write JSON results to file.", "file", "bench_output.json");
+    QCommandLineOption compareOption("compare", "Compare two result files: <baseline> <current>.");
+    QCommandLineOption thresholdOption("threshold", "Regression threshold in percent.", "percent", "10");
+    parser.addOptions({ sizesOption, iterationsOption, outputOption, compareOption, thresholdOption });
+    parser.addPositionalArgument("files", "Result files for --compare.");
+    parser.process(app);
+
+    if (parser.isSet(compareOption)) {
+        QStringList files = parser.positionalArguments();
+        if (files.size() != 2) parser.showHelp(2);
+        return compare(files[0], files[1], parser.value(thresholdOption).toDouble());
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        QTextStream(stderr) << "Cannot create temporary directory\n";
+        return 1;
+    }
+    Benchmark bench(qMax(1, parser.value(iterationsOption).toInt()));
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        runEditorBenchmarks(bench, size.toInt(), workDir.path());
+    }
+    runIncludeTreeBenchmarks(bench, workDir.path(), 200, 500);
+    runIncludeTreeBenchmarks(bench, workDir.path(), 2000, 100);
+
+    QJsonObject report;
+    report["version"] = 1;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt"] = QString(qVersion());
+    report["cpu"] = QSysInfo::currentCpuArchitecture();
+    report["results"] = bench.results;
+    QFile output(parser.value(outputOption));
+    if (!output.open(QFile::WriteOnly)) {
+        QTextStream(stderr) << "Cannot write " << output.fileName() << "\n";
+        return 1;
+    }
+    output.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    return 0;
+}
@@ -0,0 +1,350 @@
+#ifndef BUILDPIPELINE_H
+#define BUILDPIPELINE_H
+
+#include "includes.h"
+#include "trace.h"
+
+struct Diagnostic {
+    enum Severity { Info, Warning, Error, Fatal };
+    QString file;
+    int line = 0;
+    int endLine = 0;
+    Severity severity = Error;
+    int code = 0;
+    QString message;
+    QString source = "pawncc";
+    static QString severityName(Severity severity) {
+        switch (severity) {
+        case Info: return "info";
+        case Warning: return "warning";
+        case Error: return "error";
+        case Fatal: return "fatal";
+        }
+        return "error";
+    }
+    QJsonObject toJson() const {
+        QJsonObject object;
+        object["file"] = file;
+        object["line"] = line;
+        object["endLine"] = endLine;
+        object["severity"] = severityName(severity);
+        object["code"] = code;
+        object["message"] = message;
+        object["source"] = source;
+        return object;
+    }
+};
+
+class DiagnosticParser {
+public:
+    static QList<Diagnostic> parse(const QString& output) {
+        QList<Diagnostic> diagnostics;
+        const QStringList lines = output.split(QRegularExpression("[\r\n]+"), Qt::SkipEmptyParts);
+        for (const QString& line : lines) {
+            Diagnostic diagnostic;
+            if (parseLine(line, diagnostic)) {
+                diagnostics.append(diagnostic);
+            }
+        }
+        return diagnostics;
+    }
+    static bool parseLine(const QString& line, Diagnostic& diagnostic) {
+        static const QRegularExpression pattern(
+            "^(.+?)\\((\\d+)(?:\\s*--\\s*(\\d+))?\\)\\s*:\\s*(fatal error|error|warning)\\s+(\\d+)\\s*:\\s*(.*)$");
+        QRegularExpressionMatch match = pattern.match(line.trimmed());
+        if (!match.hasMatch()) return false;
+        diagnostic.file = QDir::fromNativeSeparators(match.captured(1).trimmed());
+        diagnostic.line = match.captured(2).toInt();
+        diagnostic.endLine = match.captured(3).isEmpty() ? diagnostic.line : match.captured(3).toInt();
+        QString kind = match.captured(4);
+        if (kind == "warning") {
+            diagnostic.severity = Diagnostic::Warning;
+        } else if (kind == "fatal error") {
+            diagnostic.severity = Diagnostic::Fatal;
+        } else {
+            diagnostic.severity = Diagnostic::Error;
+        }
+        diagnostic.code = match.captured(5).toInt();
+        diagnostic.message = match.captured(6).trimmed();
+        return true;
+    }
+};
+
+struct CompileRequest {
+    QString compilerPath;
+    QString sourceFile;
+    QString workingDir;
+    QString outputFile;
+    QStringList includeDirs;
+    QStringList extraArguments;
+    QStringList arguments() const {
+        QStringList args;
+        for (const QString& dir : includeDirs) {
+            args << "-i" << QDir::toNativeSeparators(dir);
+        }
+        args << extraArguments;
+        args << QDir::toNativeSeparators(sourceFile);
+        args << "-o" + outputFile;
+        return args;
+    }
+    QString key() const {
+        return compilerPath + '\n' + arguments().join('\n');
+    }
+    static CompileRequest forSource(const QString& compilerPath, const QString& sourceFile) {
+        CompileRequest request;
+        request.compilerPath = compilerPath;
+        request.sourceFile = sourceFile;
+        request.workingDir = QFileInfo(sourceFile).absolutePath();
+        request.outputFile = QFileInfo(sourceFile).baseName() + ".amx";
+        if (QDir(request.workingDir + "/pawno/include").exists()) {
+            request.includeDirs << request.workingDir + "/pawno/include";
+        }
+        if (QDir(request.workingDir + "/include").exists()) {
+            request.includeDirs << request.workingDir + "/include";
+        }
+        return request;
+    }
+};
+
+class IncludeGraph {
+public:
+    QStringList directIncludes(const QString& filePath, const QStringList& includeDirs) {
+        QFileInfo info(filePath);
+        Entry& entry = entries[info.absoluteFilePath()];
+        if (entry.parsed && entry.size == info.size() && entry.modified == info.lastModified()) {
+            return resolveAll(entry.names, info.absolutePath(), includeDirs);
+        }
+        entry = Entry();
+        entry.parsed = true;
+        entry.size = info.size();
+        entry.modified = info.lastModified();
+        QFile file(filePath);
+        if (file.open(QFile::ReadOnly)) {
+            entry.names = parseIncludes(file.readAll());
+        }
+        return resolveAll(entry.names, info.absolutePath(), includeDirs);
+    }
+    QStringList closure(const QString& rootFile, const QStringList& includeDirs) {
+        QStringList result;
+        QSet<QString> seen;
+        QStringList pending { QFileInfo(rootFile).absoluteFilePath() };
+        while (!pending.isEmpty()) {
+            QString current = pending.takeLast();
+            if (seen.contains(current)) continue;
+            seen.insert(current);
+            result.append(current);
+            pending.append(directIncludes(current, includeDirs));
+        }
+        return result;
+    }
+    static QString resolve(const QString& name, const QString& fromDir, const QStringList& includeDirs) {
+        static const QStringList extensions { "", ".inc", ".p", ".pawn" };
+        QStringList searchDirs;
+        searchDirs << fromDir << includeDirs;
+        for (const QString& dir : searchDirs) {
+            for (const QString& extension : extensions) {
+                QFileInfo candidate(QDir(dir).filePath(name + extension));
+                if (candidate.isFile()) {
+                    return candidate.absoluteFilePath();
+                }
+            }
+        }
+        return QString();
+    }
+    static QList<QPair<QString, int>> parseIncludeLines(const QByteArray& data) {
+        static const QRegularExpression pattern(
+            "^[ \\t]*#[ \\t]*(?:try)?include[ \\t]*(?:<([^>\\r\\n]+)>|\"([^\"\\r\\n]+)\"|([^\\s<\"]+))",
+            QRegularExpression::MultilineOption);
+        QList<QPair<QString, int>> includes;
+        QString text = QString::fromLatin1(data);
+        QRegularExpressionMatchIterator it = pattern.globalMatch(text);
+        int line = 0;
+        int scanned = 0;
+        while (it.hasNext()) {
+            QRegularExpressionMatch match = it.next();
+            QString name = match.captured(1) + match.captured(2) + match.captured(3);
+            line += QStringView(text).mid(scanned, match.capturedStart() - scanned).count(u'\n');
+            scanned = match.capturedStart();
+            includes.append(qMakePair(name.trimmed(), line));
+        }
+        return includes;
+    }
+private:
+    struct Entry {
+        bool parsed = false;
+        qint64 size = -1;
+        QDateTime modified;
+        QStringList names;
+    };
+    QHash<QString, Entry> entries;
+    static QStringList parseIncludes(const QByteArray& data) {
+        QStringList names;
+        for (const auto& include : parseIncludeLines(data)) {
+            names.append(include.first);
+        }
+        return names;
+    }
+    static QStringList resolveAll(const QStringList& names, const QString& fromDir, const QStringList& includeDirs) {
+        QStringList resolved;
+        for (const QString& name : names) {
+            QString path = resolve(name, fromDir, includeDirs);
+            if (!path.isEmpty()) {
+                resolved.append(path);
+            }
+        }
+        return resolved;
+    }
+};
+
+class BuildCache {
+public:
+    QByteArray fingerprint(const CompileRequest& request) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(request.key().toUtf8());
+        hash.addData(stamp(request.compilerPath));
+        QStringList inputs = includeGraph.closure(request.sourceFile, request.includeDirs);
+        std::sort(inputs.begin(), inputs.end());
+        for (const QString& input : inputs) {
+            hash.addData(input.toUtf8());
+            hash.addData(contentHash(input));
+        }
+        return hash.result();
+    }
+    bool isUpToDate(const CompileRequest& request, const QByteArray& currentFingerprint) const {
+        if (!QFile::exists(QDir(request.workingDir).filePath(request.outputFile))) return false;
+        auto it = builds.constFind(request.key());
+        return it != builds.constEnd() && it.value() == currentFingerprint;
+    }
+    void store(const CompileRequest& request, const QByteArray& builtFingerprint) {
+        builds.insert(request.key(), builtFingerprint);
+    }
+    void invalidate(const CompileRequest& request) {
+        builds.remove(request.key());
+    }
+    IncludeGraph& graph() { return includeGraph; }
+private:
+    struct FileStamp {
+        qint64 size = -1;
+        QDateTime modified;
+        QByteArray hash;
+    };
+    IncludeGraph includeGraph;
+    QHash<QString, FileStamp> stamps;
+    QHash<QString, QByteArray> builds;
+    static QByteArray stamp(const QString& path) {
+        QFileInfo info(path);
+        return QByteArray::number(info.size()) + ':' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    }
+    QByteArray contentHash(const QString& path) {
+        QFileInfo info(path);
+        FileStamp& cached = stamps[path];
+        if (!cached.hash.isEmpty() && cached.size == info.size() && cached.modified == info.lastModified()) {
+            return cached.hash;
+        }
+        cached.size = info.size();
+        cached.modified = info.lastModified();
+        QFile file(path);
+        if (file.open(QFile::ReadOnly)) {
+            QCryptographicHash hash(QCryptographicHash::Md5);
+            hash.addData(&file);
+            cached.hash = hash.result();
+        } else {
+            cached.hash = "missing";
+        }
+        return cached.hash;
+    }
+};
+
+struct CompileResult {
+    bool started = false;
+    bool cancelled = false;
+    int exitCode = -1;
+    QProcess::ExitStatus exitStatus = QProcess::NormalExit;
+    QString output;
+    QList<Diagnostic> diagnostics;
+    qint64 elapsedMs = 0;
+    bool success() const {
+        return started && !cancelled && exitStatus == QProcess::NormalExit && exitCode == 0;
+    }
+    int count(Diagnostic::Severity severity) const {
+        int total = 0;
+        for (const Diagnostic& diagnostic : diagnostics) {
+            if (diagnostic.severity == severity) ++total;
+        }
+        return total;
+    }
+};
+
+class CompileJob : public QObject {
+    Q_OBJECT
+public:
+    CompileJob(const CompileRequest& request, QObject* parent = nullptr) : QObject(parent), compileRequest(request) {}
+    const CompileRequest& request() const { return compileRequest; }
+    bool isRunning() const { return process && process->state() != QProcess::NotRunning; }
+    void start() {
+        process = new QProcess(this);
+        process->setWorkingDirectory(compileRequest.workingDir);
+        connect(process, &QProcess::readyReadStandardOutput, this, [this]() {
+            PAWNIX_TRACE("compileOutput", "compile");
+            QString text = QString::fromLocal8Bit(process->readAllStandardOutput());
+            result.output += text;
+            emit outputReady(text);
+        });
+        connect(process, &QProcess::readyReadStandardError, this, [this]() {
+            PAWNIX_TRACE("compileOutput", "compile");
+            QString text = QString::fromLocal8Bit(process->readAllStandardError());
+            result.output += text;
+            emit errorReady(text);
+        });
+        connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                finish();
+            }
+        });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+            result.started = true;
+            result.exitCode = exitCode;
+            result.exitStatus = exitStatus;
+            finish();
+        });
+        timer.start();
+        traceStart = Tracer::instance().now();
+        process->start(compileRequest.compilerPath, compileRequest.arguments());
+    }
+    void cancel() {
+        if (done) return;
+        result.cancelled = true;
+        if (isRunning()) {
+            process->terminate();
+            QTimer::singleShot(1000, process, [process = process]() {
+                if (process->state() != QProcess::NotRunning) {
+                    process->kill();
+                }
+            });
+        } else {
+            finish();
+        }
+    }
+signals:
+    void outputReady(const QString& text);
+    void errorReady(const QString& text);
+    void finished(const CompileResult& result);
+private:
+    CompileRequest compileRequest;
+    QProcess* process = nullptr;
+    CompileResult result;
+    QElapsedTimer timer;
+    bool done = false;
+    qint64 traceStart = 0;
+    void finish() {
+        if (done) return;
+        done = true;
+        result.elapsedMs = timer.isValid() ? timer.elapsed() : 0;
+        Tracer::instance().addComplete("compile", "compile", traceStart, Tracer::instance().now() - traceStart);
+        result.diagnostics = DiagnosticParser::parse(result.output);
+        emit finished(result);
+    }
+};
+
+#endif
@@ -0,0 +1,934 @@
+#ifndef CODEEDITOR_H
+#define CODEEDITOR_H
+
+#include "includes.h"
+#include "trace.h"
+#include "preprocessor.h"
+#include "symbolindex.h"
+
+class BlockData : public QTextBlockUserData {
+public:
+    struct SemanticSpan {
+        int start;
+        int length;
+        SymbolInfo::Kind kind;
+    };
+    struct Bracket {
+        int position;
+        QChar character;
+        int depth;
+        int floor;
+    };
+    PreprocessorState preprocessor;
+    bool inactive = false;
+    QVector<Bracket> brackets;
+    int depthDelta = 0;
+    int minDepth = 0;
+    QVector<SemanticSpan> semanticSpans;
+    uint semanticGeneration = 0;
+    size_t semanticTextHash = 0;
+    quint64 revision = 0;
+
+    static int resolveDepth(int start, int depth, int floor) { return start + depth + qMax(0, -(start + floor)); }
+    int depthOf(int start, const Bracket& bracket) const { return resolveDepth(start, bracket.depth, bracket.floor); }
+    int endDepth(int start) const { return resolveDepth(start, depthDelta, minDepth); }
+    int lowestDepth(int start) const { return qMax(0, start + minDepth); }
+};
+
+class PawnHighlighter : public QSyntaxHighlighter {
+public:
+    PawnHighlighter(QTextDocument* parent = nullptr) : QSyntaxHighlighter(static_cast<QObject*>(parent)) {
+        setupRules();
+        if (!parent) return;
+        knownBlocks = parent->blockCount();
+        connect(parent, &QTextDocument::contentsChange, this, &PawnHighlighter::shiftLines);
+        setDocument(parent);
+    }
+    void setIncludeMacros(const QHash<QString, MacroTable>& macros) {
+        QSet<QString> changed;
+        for (auto it = macros.constBegin(); it != macros.constEnd(); ++it) {
+            if (includeMacros.value(it.key()) != it.value()) changed.insert(it.key());
+        }
+        for (auto it = includeMacros.constBegin(); it != includeMacros.constEnd(); ++it) {
+            if (!macros.contains(it.key())) changed.insert(it.key());
+        }
+        includeMacros = macros;
+        for (int line : macroHistory.includeLines(changed)) {
+            queueDependents(line, QStringList(), true);
+        }
+    }
+    MacroTable macrosBefore(int line) const {
+        return macroHistory.table(line, includeMacros);
+    }
+    void setSemanticTable(const SemanticTable& table) {
+        if (table == semanticTable) return;
+        semanticTable = table;
+        ++semanticGeneration;
+    }
+    bool isSemanticStale(const QTextBlock& block) const {
+        BlockData* data = static_cast<BlockData*>(block.userData());
+        return data && !data->inactive && data->semanticGeneration != semanticGeneration;
+    }
+    int startDepth(const QTextBlock& block) const {
+        int number = block.blockNumber();
+        if (number < depthCache.size()) return depthCache[number];
+        QTextBlock current = document()->findBlockByNumber(depthCache.size() - 1);
+        while (depthCache.size() <= number && current.isValid()) {
+            BlockData* data = static_cast<BlockData*>(current.userData());
+            depthCache.append(data ? data->endDepth(depthCache.last()) : depthCache.last());
+            current = current.next();
+        }
+        return depthCache.value(number);
+    }
+    void invalidateDepth(int blockNumber) {
+        if (depthCache.size() > blockNumber + 1) depthCache.resize(qMax(1, blockNumber + 1));
+    }
+    void shiftLines(int position, int charsRemoved, int charsAdded) {
+        Q_UNUSED(charsRemoved);
+        QTextDocument* document = this->document();
+        if (!document) return;
+        QTextBlock firstBlock = document->findBlock(position);
+        QTextBlock lastBlock = document->findBlock(position + charsAdded);
+        int first = firstBlock.isValid() ? firstBlock.blockNumber() : document->blockCount() - 1;
+        int newEnd = (lastBlock.isValid() ? lastBlock.blockNumber() : document->blockCount() - 1) + 1;
+        int delta = document->blockCount() - knownBlocks;
+        knownBlocks = document->blockCount();
+        int oldEnd = newEnd - delta;
+        QStringList changed;
+        bool includeChanged = false;
+        if (oldEnd <= first) {
+            macroHistory.shift(-1, INT_MAX, 0, changed, includeChanged);
+            QMetaObject::invokeMethod(this, &QSyntaxHighlighter::rehighlight, Qt::QueuedConnection);
+            return;
+        }
+        macroHistory.shift(first, oldEnd, delta, changed, includeChanged);
+        queueDependents(first, changed, includeChanged);
+    }
+private:
+    mutable QVector<int> depthCache = QVector<int>(1, 0);
+    MacroHistory macroHistory;
+    int knownBlocks = 0;
+    bool dependentsQueued = false;
+    static inline quint64 revisionCounter = 0;
+    QHash<QString, MacroTable> includeMacros;
+    SemanticTable semanticTable;
+    uint semanticGeneration = 1;
+    QHash<int, QTextCharFormat> semanticFormats;
+    QTextCharFormat inactiveFormat;
+    struct HighlightRule {
+        QRegularExpression pattern;
+        QTextCharFormat format;
+    };
+    QVector<HighlightRule> rules;
+    QTextCharFormat multiLineCommentFormat;
+    void setupRules() {
+        std::vector<std::string> keywords = {
+            "assert", "break", "case", "const", "continue", "default", "do", "else", "enum", "for",
+            "forward", "functag", "goto", "if", "native", "new", "operator", "public", "return",
+            "sizeof", "static", "stock", "switch", "tagof", "while", "defined"
+        };
+        QTextCharFormat keywordFormat;
+        keywordFormat.setForeground(QColor("#569CD6"));
+        keywordFormat.setFontWeight(QFont::Bold);
+        for (const std::string& keyword : keywords) {
+            HighlightRule rule;
+            rule.pattern = QRegularExpression("\\b" + QString::fromStdString(keyword) + "\\b");
+            rule.format = keywordFormat;
+            rules.append(rule);
+        }
+        QTextCharFormat preprocessorFormat;
+        preprocessorFormat.setForeground(QColor("#C586C0"));
+        HighlightRule preprocessorRule;
+        preprocessorRule.pattern = QRegularExpression("#\\s*\\w+");
+        preprocessorRule.format = preprocessorFormat;
+        rules.append(preprocessorRule);
+        QTextCharFormat stringFormat;
+        stringFormat.setForeground(QColor("#CE9178"));
+        HighlightRule stringRule;
+        stringRule.pattern = QRegularExpression("\".*?\"");
+        stringRule.format = stringFormat;
+        rules.append(stringRule);
+        QTextCharFormat numberFormat;
+        numberFormat.setForeground(QColor("#B5CEA8"));
+        HighlightRule numberRule;
+        numberRule.pattern = QRegularExpression("\\b\\d+\\b");
+        numberRule.format = numberFormat;
+        rules.append(numberRule);
+        QTextCharFormat commentFormat;
+        commentFormat.setForeground(QColor("#6A9955"));
+        HighlightRule commentRule;
+        commentRule.pattern = QRegularExpression("//[^\\n]*");
+        commentRule.format = commentFormat;
+        rules.append(commentRule);
+        multiLineCommentFormat = commentFormat;
+        multiLineCommentFormat.setForeground(QColor("#6A9955"));
+        inactiveFormat.setForeground(QColor("#5A5A5A"));
+        QTextCharFormat functionFormat;
+        functionFormat.setForeground(QColor("#DCDCAA"));
+        semanticFormats.insert(SymbolInfo::Function, functionFormat);
+        semanticFormats.insert(SymbolInfo::Stock, functionFormat);
+        semanticFormats.insert(SymbolInfo::Static, functionFormat);
+        semanticFormats.insert(SymbolInfo::Forward, functionFormat);
+        QTextCharFormat publicFormat = functionFormat;
+        publicFormat.setFontWeight(QFont::Bold);
+        semanticFormats.insert(SymbolInfo::Public, publicFormat);
+        QTextCharFormat nativeFormat;
+        nativeFormat.setForeground(QColor("#D7BA7D"));
+        semanticFormats.insert(SymbolInfo::Native, nativeFormat);
+        QTextCharFormat defineFormat;
+        defineFormat.setForeground(QColor("#BD63C5"));
+        semanticFormats.insert(SymbolInfo::Define, defineFormat);
+        QTextCharFormat typeFormat;
+        typeFormat.setForeground(QColor("#4EC9B0"));
+        semanticFormats.insert(SymbolInfo::Enum, typeFormat);
+        semanticFormats.insert(SymbolInfo::Tag, typeFormat);
+        QTextCharFormat constantFormat;
+        constantFormat.setForeground(QColor("#4FC1FF"));
+        semanticFormats.insert(SymbolInfo::Constant, constantFormat);
+        QTextCharFormat variableFormat;
+        variableFormat.setForeground(QColor("#9CDCFE"));
+        semanticFormats.insert(SymbolInfo::Variable, variableFormat);
+    }
+    void applySemanticFormats(const QString& text, BlockData* data) {
+        size_t textHash = qHash(text);
+        if (data->semanticGeneration != semanticGeneration || data->semanticTextHash != textHash) {
+            PAWNIX_TRACE("semanticTokens", "highlight");
+            data->semanticSpans.clear();
+            if (!semanticTable.isEmpty()) {
+                for (const PawnToken& token : PawnLexer::tokenize(text)) {
+                    if (token.kind != PawnToken::Identifier) continue;
+                    auto it = semanticTable.constFind(text.mid(token.start, token.length));
+                    if (it != semanticTable.constEnd()) {
+                        data->semanticSpans.append(BlockData::SemanticSpan { token.start, token.length, it.value() });
+                    }
+                }
+            }
+            data->semanticGeneration = semanticGeneration;
+            data->semanticTextHash = textHash;
+        }
+        for (const BlockData::SemanticSpan& span : data->semanticSpans) {
+            if (format(span.start).hasProperty(QTextFormat::ForegroundBrush)) continue;
+            setFormat(span.start, span.length, semanticFormats.value(span.kind));
+        }
+    }
+    void highlightBlock(const QString& text) override {
+        PAWNIX_TRACE("highlightBlock", "highlight");
+        for (const HighlightRule& rule : rules) {
+            QRegularExpressionMatchIterator it = rule.pattern.globalMatch(text);
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+            }
+        }
+        bool commentOpen = false;
+        bool startsInComment = previousBlockState() >= 0 && (previousBlockState() & 1);
+        int startIndex = 0;
+        if (!startsInComment) {
+            startIndex = text.indexOf("/*");
+        }
+        while (startIndex >= 0) {
+            int endIndex = text.indexOf("*/", startIndex);
+            int commentLength;
+            if (endIndex == -1) {
+                commentOpen = true;
+                commentLength = text.length() - startIndex;
+            } else {
+                commentLength = endIndex - startIndex + 2;
+            }
+            setFormat(startIndex, commentLength, multiLineCommentFormat);
+            startIndex = text.indexOf("/*", startIndex + commentLength);
+        }
+        BlockData* previous = static_cast<BlockData*>(currentBlock().previous().userData());
+        BlockData* data = static_cast<BlockData*>(currentBlockUserData());
+        bool fresh = !data;
+        if (!data) {
+            data = new BlockData();
+            setCurrentBlockUserData(data);
+        }
+        PreprocessorState state = previous ? previous->preprocessor : PreprocessorState();
+        int line = currentBlock().blockNumber();
+        LineEffect effect;
+        bool active = state.isActive();
+        bool directiveLine = previous && previous->preprocessor.continuation;
+        if (!startsInComment) {
+            QString directive;
+            QStringView rest;
+            if (PreprocessorModel::isDirective(text, directive, rest)) directiveLine = true;
+            active = PreprocessorModel::processLine(state, text, [this, line](const QString& name) {
+                return macroHistory.find(name, line, includeMacros);
+            }, line, effect);
+        }
+        QStringList changedMacros;
+        bool includeChanged = false;
+        macroHistory.apply(line, effect, changedMacros, includeChanged);
+        queueDependents(line, changedMacros, includeChanged);
+        bool stateChanged = fresh || !(state == data->preprocessor);
+        data->preprocessor = state;
+        data->inactive = !active;
+        data->revision = ++revisionCounter;
+        int depthDelta = data->depthDelta;
+        int minDepth = data->minDepth;
+        scanBrackets(text, startsInComment, active && !directiveLine, data);
+        if (fresh || depthDelta != data->depthDelta || minDepth != data->minDepth) invalidateDepth(line);
+        if (!active) {
+            setFormat(0, text.length(), inactiveFormat);
+        } else {
+            applySemanticFormats(text, data);
+        }
+        int toggle = currentBlockState() >= 0 ? (currentBlockState() >> 1) & 1 : 0;
+        if (stateChanged) toggle ^= 1;
+        setCurrentBlockState((toggle << 1) | (commentOpen ? 1 : 0));
+    }
+    void queueDependents(int line, const QStringList& names, bool all) {
+        if (names.isEmpty() && !all) return;
+        macroHistory.markDependents(line, names, all);
+        if (dependentsQueued) return;
+        dependentsQueued = true;
+        QMetaObject::invokeMethod(this, &PawnHighlighter::rehighlightDependents, Qt::QueuedConnection);
+    }
+    void rehighlightDependents() {
+        dependentsQueued = false;
+        if (!document()) return;
+        for (int line : macroHistory.takeDirty()) {
+            QTextBlock block = document()->findBlockByNumber(line);
+            if (block.isValid()) rehighlightBlock(block);
+        }
+    }
+    static void scanBrackets(const QString& text, bool inComment, bool active, BlockData* data) {
+        data->brackets.clear();
+        int depth = 0;
+        data->minDepth = 0;
+        for (int i = 0; active && i < text.size(); ++i) {
+            QChar c = text[i];
+            if (inComment) {
+                if (c == '*' && i + 1 < text.size() && text[i + 1] == '/') {
+                    inComment = false;
+                    ++i;
+                }
+                continue;
+            }
+            if (c == '/' && i + 1 < text.size() && text[i + 1] == '/') break;
+            if (c == '/' && i + 1 < text.size() && text[i + 1] == '*') {
+                inComment = true;
+                ++i;
+            } else if (c == '"' || c == '\'') {
+                for (++i; i < text.size() && text[i] != c; ++i) {
+                    if (text[i] == '\\') ++i;
+                }
+            } else if (c == '{') {
+                data->brackets.append(BlockData::Bracket { i, c, ++depth, data->minDepth });
+            } else if (c == '}') {
+                data->brackets.append(BlockData::Bracket { i, c, depth, data->minDepth });
+                data->minDepth = qMin(data->minDepth, --depth);
+            } else if (c == '(' || c == ')' || c == '[' || c == ']') {
+                data->brackets.append(BlockData::Bracket { i, c, depth, data->minDepth });
+            }
+        }
+        data->depthDelta = depth;
+    }
+};
+struct EditorDecoration {
+    enum Style { Line, Underline, Highlight, Gutter };
+    int line = 0;
+    int column = -1;
+    int length = 0;
+    Style style = Line;
+    QColor color;
+    QString message;
+};
+
+struct GutterRange {
+    int line = 0;
+    int count = 1;
+    QColor color;
+
+    bool operator==(const GutterRange& other) const {
+        return line == other.line && count == other.count && color == other.color;
+    }
+};
+
+class CodeEditor : public QPlainTextEdit {
+    Q_OBJECT
+public:
+    CodeEditor(QWidget* parent = nullptr) : QPlainTextEdit(parent) {
+        QFont font;
+        font.setFamily("Consolas");
+        font.setPointSize(12);
+        setFont(font);
+        QPalette p = palette();
+        p.setColor(QPalette::Base, QColor("#1E1E1E"));
+        p.setColor(QPalette::Text, QColor("#D4D4D4"));
+        p.setColor(QPalette::Highlight, QColor("#264F78"));
+        p.setColor(QPalette::HighlightedText, Qt::white);
+        setPalette(p);
+        highlighter = new PawnHighlighter(document());
+        setTabStopDistance(4 * fontMetrics().horizontalAdvance(' '));
+        connect(this, &CodeEditor::blockCountChanged, this, &CodeEditor::updateLineNumberAreaWidth);
+        connect(this, &CodeEditor::updateRequest, this, &CodeEditor::updateLineNumberArea);
+        connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
+        semanticTimer = new QTimer(this);
+        semanticTimer->setSingleShot(true);
+        semanticTimer->setInterval(0);
+        connect(semanticTimer, &QTimer::timeout, this, &CodeEditor::refreshSemanticHighlighting);
+        connect(verticalScrollBar(), &QScrollBar::valueChanged, semanticTimer, QOverload<>::of(&QTimer::start));
+        lineNumberArea = new LineNumberArea(this);
+        minimap = new Minimap(this);
+        connect(verticalScrollBar(), &QScrollBar::valueChanged, minimap, [this]() { minimap->update(); });
+        connect(verticalScrollBar(), &QScrollBar::rangeChanged, this, &CodeEditor::updateMinimapGeometry);
+        connect(document(), &QTextDocument::contentsChanged, minimap, [this]() { minimap->update(); });
+        connect(document(), &QTextDocument::contentsChange, this, [this](int position) {
+            highlighter->invalidateDepth(document()->findBlock(position).blockNumber());
+            viewport()->update();
+        });
+        updateLineNumberAreaWidth(0);
+        highlightCurrentLine();
+    }
+    int lineNumberAreaWidth() {
+        int digits = 1;
+        int max = qMax(1, blockCount());
+        while (max >= 10) {
+            max /= 10;
+            ++digits;
+        }
+        return 10 + fontMetrics().horizontalAdvance('9') * digits;
+    }
+    void lineNumberAreaPaintEvent(QPaintEvent *event) {
+        PAWNIX_TRACE("lineNumberAreaPaintEvent", "paint");
+        QPainter painter(lineNumberArea);
+        painter.fillRect(event->rect(), QColor("#252526"));
+        QTextBlock block = firstVisibleBlock();
+        int blockNumber = block.blockNumber();
+        int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
+        int bottom = top + (int)blockBoundingRect(block).height();
+        auto change = std::lower_bound(gitChanges.constBegin(), gitChanges.constEnd(), blockNumber, [](const GutterRange& range, int line) {
+            return range.line + range.count <= line;
+        });
+        while (block.isValid() && top <= event->rect().bottom()) {
+            while (change != gitChanges.constEnd() && change->line + change->count <= blockNumber) ++change;
+            if (block.isVisible() && bottom >= event->rect().top()) {
+                QString number = QString::number(blockNumber + 1);
+                painter.setPen(QColor("#7A7A7A"));
+                painter.drawText(0, top, lineNumberArea->width() - 5, fontMetrics().height(),
+                                 Qt::AlignRight, number);
+                auto mark = gutterMarks.constFind(blockNumber);
+                if (mark != gutterMarks.constEnd()) {
+                    painter.fillRect(0, top, 3, fontMetrics().height(), mark.value());
+                }
+                if (change != gitChanges.constEnd() && change->line <= blockNumber) {
+                    painter.fillRect(lineNumberArea->width() - 3, top, 3, fontMetrics().height(), change->color);
+                }
+            }
+            block = block.next();
+            top = bottom;
+            bottom = top + (int)blockBoundingRect(block).height();
+            ++blockNumber;
+        }
+    }
+    void minimapPaintEvent(QPaintEvent *event) {
+        PAWNIX_TRACE("minimapPaintEvent", "paint");
+        QPainter painter(minimap);
+        painter.fillRect(event->rect(), palette().color(QPalette::Base));
+        int first = minimapFirstRow();
+        int last = qMin(blockCount(), first + minimap->height() / MinimapRowHeight + 1);
+        QTextBlock block = document()->findBlockByNumber(first);
+        for (int row = first; row < last && block.isValid(); ++row, block = block.next()) {
+            MinimapTile& tile = minimapTile(row / MinimapTileRows);
+            BlockData* data = static_cast<BlockData*>(block.userData());
+            quint64 revision = data ? data->revision : 0;
+            int offset = row % MinimapTileRows;
+            if (revision == 0 || tile.revisions[offset] != revision) {
+                renderMinimapRow(tile.image, offset, block);
+                tile.revisions[offset] = revision;
+            }
+        }
+        int firstTile = first / MinimapTileRows;
+        int lastTile = qMax(firstTile, (last - 1) / MinimapTileRows);
+        for (auto it = minimapTiles.begin(); it != minimapTiles.end();) {
+            if (it.key() < firstTile - 2 || it.key() > lastTile + 2) it = minimapTiles.erase(it);
+            else ++it;
+        }
+        for (int index = firstTile; index <= lastTile; ++index) {
+            auto tile = minimapTiles.constFind(index);
+            if (tile != minimapTiles.constEnd()) painter.drawImage(0, (index * MinimapTileRows - first) * MinimapRowHeight, tile->image);
+        }
+        int visibleFirst = firstVisibleBlock().blockNumber();
+        int visibleRows = viewport()->height() / qMax(1, fontMetrics().height());
+        painter.fillRect(QRect(0, (visibleFirst - first) * MinimapRowHeight, minimap->width(), visibleRows * MinimapRowHeight),
+                         QColor(255, 255, 255, 24));
+        for (const QList<EditorDecoration>& layer : decorationLayers) {
+            for (const EditorDecoration& decoration : layer) {
+                if (decoration.line < first || decoration.line >= last) continue;
+                int y = (decoration.line - first) * MinimapRowHeight;
+                if (decoration.style == EditorDecoration::Highlight) {
+                    QColor color = decoration.color;
+                    color.setAlpha(120);
+                    painter.fillRect(0, y, minimap->width(), MinimapRowHeight, color);
+                } else {
+                    painter.fillRect(minimap->width() - 4, y - 1, 4, MinimapRowHeight + 2, decoration.color);
+                }
+            }
+        }
+    }
+    void minimapMouseEvent(QMouseEvent *event) {
+        if (!(event->buttons() & Qt::LeftButton)) return;
+        int row = minimapFirstRow() + int(event->position().y()) / MinimapRowHeight;
+        int visibleRows = viewport()->height() / qMax(1, fontMetrics().height());
+        verticalScrollBar()->setValue(qBound(0, row - visibleRows / 2, verticalScrollBar()->maximum()));
+    }
+    void setMinimapVisible(bool visible) {
+        minimap->setVisible(visible);
+        if (!visible) minimapTiles.clear();
+        updateLineNumberAreaWidth(0);
+        updateMinimapGeometry();
+    }
+    void findText(const QString& text, bool caseSensitive, bool wholeWords) {
+        PAWNIX_TRACE("findText", "search");
+        QTextDocument* doc = document();
+        QTextCursor cursor(doc);
+        QList<EditorDecoration> matches;
+        setDecorations("search", matches);
+        if (text.isEmpty()) return;
+        QRegularExpression pattern(text);
+        pattern.setPatternOptions(wholeWords ? QRegularExpression::UseUnicodePropertiesOption | QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
+        if (caseSensitive) pattern.setPatternOptions(pattern.patternOptions() ^ QRegularExpression::CaseInsensitiveOption);
+        while (!cursor.isNull() && cursor.movePosition(QTextCursor::NextBlock)) {
+            QRegularExpressionMatchIterator it = pattern.globalMatch(cursor.block().text());
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                EditorDecoration decoration;
+                decoration.line = cursor.blockNumber();
+                decoration.column = int(match.capturedStart());
+                decoration.length = int(match.capturedLength());
+                decoration.style = EditorDecoration::Highlight;
+                decoration.color = Qt::yellow;
+                matches.append(decoration);
+            }
+        }
+        setDecorations("search", matches);
+    }
+    void replaceText(const QString& searchText, const QString& replaceText, bool caseSensitive, bool wholeWords) {
+        PAWNIX_TRACE("replaceText", "search");
+        QTextCursor cursor(document());
+        int count = 0;
+        QRegularExpression pattern(searchText);
+        pattern.setPatternOptions(wholeWords ? QRegularExpression::UseUnicodePropertiesOption | QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
+        if (caseSensitive) pattern.setPatternOptions(pattern.patternOptions() ^ QRegularExpression::CaseInsensitiveOption);
+        while (!cursor.isNull() && cursor.movePosition(QTextCursor::NextBlock)) {
+            QRegularExpressionMatchIterator it = pattern.globalMatch(cursor.block().text());
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                cursor.setPosition(cursor.block().position() + match.capturedStart());
+                cursor.setPosition(cursor.block().position() + match.capturedEnd(), QTextCursor::KeepAnchor);
+                cursor.insertText(replaceText);
+                count++;
+            }
+        }
+        if (count > 0) {
+            QTextCursor tc = textCursor();
+            tc.movePosition(QTextCursor::Start);
+            setTextCursor(tc);
+        }
+    }
+    QWidget* lineNumberWidget() const { return lineNumberArea; }
+    PawnHighlighter* syntaxHighlighter() const { return highlighter; }
+    QString filePath() const { return path; }
+    void setFilePath(const QString& fileName) { path = fileName; }
+    void setSemanticTable(const SemanticTable& table) {
+        highlighter->setSemanticTable(table);
+        refreshSemanticHighlighting();
+    }
+    void refreshSemanticHighlighting() {
+        PAWNIX_TRACE("refreshSemanticHighlighting", "highlight");
+        QTextBlock block = firstVisibleBlock();
+        int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
+        int bottom = viewport()->height();
+        while (block.isValid() && top <= bottom) {
+            if (block.isVisible() && highlighter->isSemanticStale(block)) {
+                highlighter->rehighlightBlock(block);
+            }
+            top += (int)blockBoundingRect(block).height();
+            block = block.next();
+        }
+    }
+    void goToLine(int lineNumber) {
+        if (lineNumber < 1 || lineNumber > blockCount()) return;
+        QTextCursor cursor(document()->findBlockByNumber(lineNumber - 1));
+        cursor.movePosition(QTextCursor::StartOfLine);
+        setTextCursor(cursor);
+        verticalScrollBar()->setValue(cursor.position());
+    }
+    void goToPosition(int line, int column) {
+        QTextBlock block = document()->findBlockByNumber(line);
+        if (!block.isValid()) return;
+        QTextCursor cursor(block);
+        cursor.setPosition(block.position() + qBound(0, column, block.length() - 1));
+        setTextCursor(cursor);
+        centerCursor();
+    }
+    void setDecorations(const QString& layer, const QList<EditorDecoration>& items) {
+        PAWNIX_TRACE("setDecorations", "paint");
+        if (items.isEmpty()) {
+            if (!decorationLayers.remove(layer)) return;
+        } else {
+            decorationLayers.insert(layer, items);
+        }
+        rebuildDecorations();
+    }
+    void setGitChanges(const QList<GutterRange>& ranges) {
+        if (ranges == gitChanges) return;
+        gitChanges = ranges;
+        lineNumberArea->update();
+    }
+    QList<EditorDecoration> decorations(const QString& layer) const {
+        return decorationLayers.value(layer);
+    }
+    int matchingBracket(const QTextBlock& originBlock, int index) const {
+        PAWNIX_TRACE("matchingBracket", "navigation");
+        BlockData* originData = static_cast<BlockData*>(originBlock.userData());
+        const BlockData::Bracket origin = originData->brackets[index];
+        int originDepth = originData->depthOf(highlighter->startDepth(originBlock), origin);
+        bool forward = origin.character == '(' || origin.character == '[' || origin.character == '{';
+        bool brace = origin.character == '{' || origin.character == '}';
+        QChar target = origin.character == '(' ? ')' : origin.character == ')' ? '(' : origin.character == '[' ? ']'
+                     : origin.character == ']' ? '[' : origin.character == '{' ? '}' : '{';
+        int balance = 0;
+        int scanned = 0;
+        QTextBlock block = originBlock;
+        int i = index + (forward ? 1 : -1);
+        while (block.isValid()) {
+            BlockData* data = static_cast<BlockData*>(block.userData());
+            int start = data && brace ? highlighter->startDepth(block) : 0;
+            bool skip = !data || (brace && block != originBlock && data->lowestDepth(start) >= originDepth);
+            if (!skip) {
+                if (block != originBlock) i = forward ? 0 : data->brackets.size() - 1;
+                for (; i >= 0 && i < data->brackets.size(); i += forward ? 1 : -1) {
+                    const BlockData::Bracket& bracket = data->brackets[i];
+                    if (brace) {
+                        if (bracket.character == target && data->depthOf(start, bracket) == originDepth) return block.position() + bracket.position;
+                    } else if (bracket.character == origin.character) {
+                        ++balance;
+                    } else if (bracket.character == target && balance-- == 0) {
+                        return block.position() + bracket.position;
+                    }
+                }
+            }
+            if (!brace && ++scanned > 2000) break;
+            block = forward ? block.next() : block.previous();
+        }
+        return -1;
+    }
+    void jumpToMatchingBracket() {
+        QTextCursor cursor = textCursor();
+        BlockData* data = static_cast<BlockData*>(cursor.block().userData());
+        if (!data) return;
+        int column = cursor.positionInBlock();
+        for (int i = 0; i < data->brackets.size(); ++i) {
+            int position = data->brackets[i].position;
+            if (position != column && position != column - 1) continue;
+            int match = matchingBracket(cursor.block(), i);
+            if (match < 0) return;
+            cursor.setPosition(match);
+            setTextCursor(cursor);
+            ensureCursorVisible();
+            return;
+        }
+    }
+    void goToEnclosingFunction() {
+        PAWNIX_TRACE("goToEnclosingFunction", "navigation");
+        QTextCursor cursor = textCursor();
+        BlockData* data = static_cast<BlockData*>(cursor.block().userData());
+        if (!data) return;
+        int start = highlighter->startDepth(cursor.block());
+        int depth = start;
+        for (const BlockData::Bracket& bracket : data->brackets) {
+            if (bracket.position >= cursor.positionInBlock()) break;
+            if (bracket.character == '{') depth = data->depthOf(start, bracket);
+            else if (bracket.character == '}') depth = data->depthOf(start, bracket) - 1;
+        }
+        if (depth <= 0) return;
+        int column = cursor.positionInBlock();
+        for (QTextBlock block = cursor.block(); block.isValid(); block = block.previous(), column = INT_MAX) {
+            data = static_cast<BlockData*>(block.userData());
+            if (!data) continue;
+            start = highlighter->startDepth(block);
+            if (data->lowestDepth(start) >= 1) continue;
+            for (int i = data->brackets.size() - 1; i >= 0; --i) {
+                const BlockData::Bracket& bracket = data->brackets[i];
+                if (bracket.position >= column || bracket.character != '{' || data->depthOf(start, bracket) != 1) continue;
+                QTextBlock header = block;
+                if (block.text().trimmed().startsWith('{') && block.previous().isValid()) header = block.previous();
+                setTextCursor(QTextCursor(header));
+                centerCursor();
+                return;
+            }
+        }
+    }
+    QString identifierAtCursor() const {
+        QTextCursor cursor = textCursor();
+        QString text = cursor.block().text();
+        int start = cursor.positionInBlock();
+        int end = start;
+        while (start > 0 && PawnLexer::isIdentifierChar(text[start - 1])) --start;
+        while (end < text.size() && PawnLexer::isIdentifierChar(text[end])) ++end;
+        if (start == end || !PawnLexer::isIdentifierStart(text[start])) return QString();
+        return text.mid(start, end - start);
+    }
+protected:
+    void paintEvent(QPaintEvent *event) override {
+        PAWNIX_TRACE("paintEvent", "paint");
+        QPlainTextEdit::paintEvent(event);
+        paintScopeGuides(event);
+    }
+    void paintScopeGuides(QPaintEvent *event) {
+        QPainter painter(viewport());
+        painter.setPen(QColor("#404040"));
+        qreal step = tabStopDistance();
+        qreal space = fontMetrics().horizontalAdvance(' ');
+        qreal left = contentOffset().x() + document()->documentMargin();
+        QTextBlock block = firstVisibleBlock();
+        qreal top = blockBoundingGeometry(block).translated(contentOffset()).top();
+        while (block.isValid() && top <= event->rect().bottom()) {
+            qreal height = blockBoundingRect(block).height();
+            BlockData* data = static_cast<BlockData*>(block.userData());
+            if (data && block.isVisible() && top + height >= event->rect().top()) {
+                QString text = block.text();
+                int leading = 0;
+                int columns = 0;
+                while (leading < text.size() && text[leading].isSpace()) {
+                    columns = text[leading] == '\t' ? (columns / 4 + 1) * 4 : columns + 1;
+                    ++leading;
+                }
+                int depth = highlighter->startDepth(block);
+                if (leading < text.size() && text[leading] == '}') --depth;
+                qreal indent = leading < text.size() ? columns * space : qreal(INT_MAX);
+                for (int level = 0; level < depth && level * step < indent; ++level) {
+                    qreal x = left + level * step;
+                    painter.drawLine(QPointF(x, top), QPointF(x, top + height));
+                }
+            }
+            block = block.next();
+            top += height;
+        }
+    }
+    bool viewportEvent(QEvent *event) override {
+        if (event->type() == QEvent::ToolTip) {
+            QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+            QTextCursor cursor = cursorForPosition(helpEvent->pos());
+            QStringList messages;
+            for (const QList<EditorDecoration>& layer : decorationLayers) {
+                for (const EditorDecoration& decoration : layer) {
+                    if (decoration.message.isEmpty() || decoration.line != cursor.blockNumber()) continue;
+                    if (decoration.column >= 0 && (cursor.positionInBlock() < decoration.column
+                                                   || cursor.positionInBlock() > decoration.column + decoration.length)) continue;
+                    messages << decoration.message;
+                }
+            }
+            if (messages.isEmpty()) {
+                QToolTip::hideText();
+            } else {
+                QToolTip::showText(helpEvent->globalPos(), messages.join('\n'), viewport());
+            }
+            return true;
+        }
+        return QPlainTextEdit::viewportEvent(event);
+    }
+    void resizeEvent(QResizeEvent *event) override {
+        PAWNIX_TRACE("resizeEvent", "layout");
+        QPlainTextEdit::resizeEvent(event);
+        QRect cr = contentsRect();
+        lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+        updateMinimapGeometry();
+        if (semanticTimer) semanticTimer->start();
+    }
+private slots:
+    void updateLineNumberAreaWidth(int newBlockCount) {
+        Q_UNUSED(newBlockCount);
+        setViewportMargins(lineNumberAreaWidth(), 0, minimapWidth(), 0);
+    }
+    void updateMinimapGeometry() {
+        QRect viewportRect = viewport()->geometry();
+        minimap->setGeometry(viewportRect.right() + 1, viewportRect.top(), minimapWidth(), viewportRect.height());
+    }
+    void updateLineNumberArea(const QRect& rect, int dy) {
+        if (dy)
+            lineNumberArea->scroll(0, dy);
+        else
+            lineNumberArea->update(0, rect.y(), lineNumberArea->width(), rect.height());
+    }
+    void rebuildDecorations() {
+        decorationSelections.clear();
+        gutterMarks.clear();
+        for (const QList<EditorDecoration>& layer : decorationLayers) {
+            for (const EditorDecoration& decoration : layer) {
+                QTextBlock block = document()->findBlockByNumber(decoration.line);
+                if (!block.isValid()) continue;
+                if (decoration.style == EditorDecoration::Gutter) {
+                    gutterMarks.insert(decoration.line, decoration.color);
+                    continue;
+                }
+                QTextEdit::ExtraSelection selection;
+                selection.cursor = QTextCursor(block);
+                if (decoration.column < 0) {
+                    QColor background = decoration.color;
+                    background.setAlpha(40);
+                    selection.format.setBackground(background);
+                    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+                } else {
+                    int start = block.position() + qMin(decoration.column, block.length() - 1);
+                    selection.cursor.setPosition(start);
+                    selection.cursor.setPosition(qMin(start + decoration.length, block.position() + block.length() - 1), QTextCursor::KeepAnchor);
+                    if (decoration.style == EditorDecoration::Underline) {
+                        selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+                        selection.format.setUnderlineColor(decoration.color);
+                    } else {
+                        selection.format.setBackground(decoration.color);
+                    }
+                }
+                decorationSelections.append(selection);
+                if (decoration.style != EditorDecoration::Highlight) {
+                    gutterMarks.insert(decoration.line, decoration.color);
+                }
+            }
+        }
+        highlightCurrentLine();
+        lineNumberArea->update();
+        minimap->update();
+    }
+    void matchBrackets() {
+        bracketSelections.clear();
+        QTextCursor cursor = textCursor();
+        BlockData* data = static_cast<BlockData*>(cursor.block().userData());
+        if (!data) return;
+        int column = cursor.positionInBlock();
+        for (int i = 0; i < data->brackets.size(); ++i) {
+            int position = data->brackets[i].position;
+            if (position != column && position != column - 1) continue;
+            int match = matchingBracket(cursor.block(), i);
+            QTextEdit::ExtraSelection selection;
+            selection.format.setBackground(QColor(match < 0 ? "#6B2A2A" : "#3B514D"));
+            selection.cursor = QTextCursor(document());
+            selection.cursor.setPosition(cursor.block().position() + position);
+            selection.cursor.setPosition(cursor.block().position() + position + 1, QTextCursor::KeepAnchor);
+            bracketSelections.append(selection);
+            if (match >= 0) {
+                selection.cursor.setPosition(match);
+                selection.cursor.setPosition(match + 1, QTextCursor::KeepAnchor);
+                bracketSelections.append(selection);
+            }
+            return;
+        }
+    }
+    void highlightCurrentLine() {
+        matchBrackets();
+        QList<QTextEdit::ExtraSelection> extraSelections;
+        if (!isReadOnly()) {
+            QTextEdit::ExtraSelection selection;
+            selection.format.setBackground(QColor("#2D2D30"));
+            selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+            selection.cursor = textCursor();
+            selection.cursor.clearSelection();
+            extraSelections.append(selection);
+        }
+        extraSelections.append(decorationSelections);
+        extraSelections.append(bracketSelections);
+        setExtraSelections(extraSelections);
+    }
+private:
+    class LineNumberArea : public QWidget {
+    public:
+        LineNumberArea(CodeEditor *editor) : QWidget(editor), codeEditor(editor) {}
+    protected:
+        void paintEvent(QPaintEvent *event) override {
+            codeEditor->lineNumberAreaPaintEvent(event);
+        }
+    private:
+        CodeEditor *codeEditor;
+    };
+    class Minimap : public QWidget {
+    public:
+        Minimap(CodeEditor *editor) : QWidget(editor), codeEditor(editor) {
+            setCursor(Qt::PointingHandCursor);
+        }
+    protected:
+        void paintEvent(QPaintEvent *event) override {
+            codeEditor->minimapPaintEvent(event);
+        }
+        void mousePressEvent(QMouseEvent *event) override {
+            codeEditor->minimapMouseEvent(event);
+        }
+        void mouseMoveEvent(QMouseEvent *event) override {
+            codeEditor->minimapMouseEvent(event);
+        }
+    private:
+        CodeEditor *codeEditor;
+    };
+    struct MinimapTile {
+        QImage image;
+        QVector<quint64> revisions;
+    };
+    static constexpr int MinimapColumns = 110;
+    static constexpr int MinimapRowHeight = 2;
+    static constexpr int MinimapTileRows = 256;
+    int minimapWidth() const {
+        return minimap->isHidden() ? 0 : MinimapColumns;
+    }
+    int minimapFirstRow() const {
+        int rows = qMax(1, minimap->height() / MinimapRowHeight);
+        if (blockCount() <= rows) return 0;
+        QScrollBar* bar = verticalScrollBar();
+        double ratio = bar->maximum() > 0 ? double(bar->value()) / bar->maximum() : 0;
+        return qRound(ratio * (blockCount() - rows));
+    }
+    MinimapTile& minimapTile(int index) {
+        auto it = minimapTiles.find(index);
+        if (it == minimapTiles.end()) {
+            MinimapTile tile;
+            tile.image = QImage(MinimapColumns, MinimapTileRows * MinimapRowHeight, QImage::Format_RGB32);
+            tile.image.fill(palette().color(QPalette::Base));
+            tile.revisions.fill(0, MinimapTileRows);
+            it = minimapTiles.insert(index, tile);
+        }
+        return it.value();
+    }
+    void renderMinimapRow(QImage& image, int offset, const QTextBlock& block) {
+        QColor base = palette().color(QPalette::Base);
+        auto dim = [&base](const QColor& color) {
+            return qRgb((color.red() * 3 + base.red() * 2) / 5, (color.green() * 3 + base.green() * 2) / 5,
+                        (color.blue() * 3 + base.blue() * 2) / 5);
+        };
+        QString text = block.text();
+        QVector<QRgb> charColors(text.size(), dim(palette().color(QPalette::Text)));
+        for (const QTextLayout::FormatRange& range : block.layout()->formats()) {
+            if (!range.format.hasProperty(QTextFormat::ForegroundBrush)) continue;
+            QRgb color = dim(range.format.foreground().color());
+            for (int i = qMax(0, range.start); i < qMin(int(text.size()), range.start + range.length); ++i) charColors[i] = color;
+        }
+        QVarLengthArray<QRgb, MinimapColumns> pixels(MinimapColumns);
+        std::fill(pixels.begin(), pixels.end(), base.rgb());
+        int column = 0;
+        for (int i = 0; i < text.size() && column < MinimapColumns; ++i) {
+            if (text[i] == '\t') {
+                column += 4 - column % 4;
+                continue;
+            }
+            if (!text[i].isSpace()) pixels[column] = charColors[i];
+            ++column;
+        }
+        for (int line = 0; line < MinimapRowHeight; ++line) {
+            memcpy(image.scanLine(offset * MinimapRowHeight + line), pixels.constData(), MinimapColumns * sizeof(QRgb));
+        }
+    }
+    LineNumberArea *lineNumberArea;
+    Minimap *minimap;
+    QHash<int, MinimapTile> minimapTiles;
+    PawnHighlighter* highlighter;
+    QTimer* semanticTimer = nullptr;
+    QHash<QString, QList<EditorDecoration>> decorationLayers;
+    QList<QTextEdit::ExtraSelection> decorationSelections;
+    QList<QTextEdit::ExtraSelection> bracketSelections;
+    QHash<int, QColor> gutterMarks;
+    QList<GutterRange> gitChanges;
+    QString path;
+};
+
+#endif
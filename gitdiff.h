@@ -0,0 +1,268 @@
+#ifndef GITDIFF_H
+#define GITDIFF_H
+
+#include "includes.h"
+#include "codeeditor.h"
+#include "sourcefile.h"
+#include "trace.h"
+
+struct DiffHunk {
+    int baseStart = 0;
+    int baseCount = 0;
+    int currentStart = 0;
+    int currentCount = 0;
+
+    bool operator==(const DiffHunk& other) const {
+        return baseStart == other.baseStart && baseCount == other.baseCount
+               && currentStart == other.currentStart && currentCount == other.currentCount;
+    }
+};
+
+class LineDiff {
+public:
+    void reset(const QStringList& baseLines, const QStringList& currentLines) {
+        PAWNIX_TRACE("diffReset", "git");
+        base = baseLines;
+        hunks = diff(base, 0, base.size(), currentLines, 0);
+    }
+    void update(int first, int oldEnd, int newEnd, const std::function<QStringList(int, int)>& currentLines) {
+        PAWNIX_TRACE("diffUpdate", "git");
+        int delta = newEnd - oldEnd;
+        int start = first;
+        int end = oldEnd;
+        int offsetBefore = 0;
+        int touchedDelta = 0;
+        int firstTouched = hunks.size();
+        int lastTouched = -1;
+        for (int i = 0; i < hunks.size(); ++i) {
+            const DiffHunk& hunk = hunks[i];
+            int hunkEnd = hunk.currentStart + hunk.currentCount;
+            if (hunkEnd < first) {
+                offsetBefore += hunk.currentCount - hunk.baseCount;
+                continue;
+            }
+            if (hunk.currentStart > oldEnd) break;
+            firstTouched = qMin(firstTouched, i);
+            lastTouched = i;
+            start = qMin(start, hunk.currentStart);
+            end = qMax(end, hunkEnd);
+            touchedDelta += hunk.currentCount - hunk.baseCount;
+        }
+        int baseStart = start - offsetBefore;
+        int baseEnd = end - offsetBefore - touchedDelta;
+        QList<DiffHunk> replaced = diff(base, baseStart, qMin(baseEnd, int(base.size())), currentLines(start, end + delta), start);
+        if (lastTouched >= firstTouched) {
+            hunks.remove(firstTouched, lastTouched - firstTouched + 1);
+        } else {
+            firstTouched = 0;
+            while (firstTouched < hunks.size() && hunks[firstTouched].currentStart < start) ++firstTouched;
+        }
+        for (int i = firstTouched; i < hunks.size(); ++i) {
+            hunks[i].currentStart += delta;
+        }
+        for (int i = 0; i < replaced.size(); ++i) {
+            hunks.insert(firstTouched + i, replaced[i]);
+        }
+    }
+    const QList<DiffHunk>& changes() const { return hunks; }
+    static QList<DiffHunk> diff(const QStringList& a, int aFrom, int aTo, const QStringList& b, int bOffset) {
+        int prefix = 0;
+        while (aFrom + prefix < aTo && prefix < b.size() && a[aFrom + prefix] == b[prefix]) ++prefix;
+        int suffix = 0;
+        while (aTo - suffix > aFrom + prefix && b.size() - suffix > prefix && a[aTo - suffix - 1] == b[b.size() - suffix - 1]) ++suffix;
+        int n = aTo - aFrom - prefix - suffix;
+        int m = b.size() - prefix - suffix;
+        int aStart = aFrom + prefix;
+        int bStart = prefix;
+        QList<DiffHunk> result;
+        if (n == 0 && m == 0) return result;
+        if (n == 0 || m == 0) {
+            result.append(DiffHunk { aStart, n, bOffset + bStart, m });
+            return result;
+        }
+        const int maxEdits = 2000;
+        int max = n + m;
+        QVector<int> v(2 * max + 3, 0);
+        int offset = max + 1;
+        QVector<QVector<int>> trace;
+        bool found = false;
+        for (int d = 0; d <= max && d <= maxEdits && !found; ++d) {
+            trace.append(v.mid(offset - d - 1, 2 * d + 3));
+            for (int k = -d; k <= d; k += 2) {
+                int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+                int y = x - k;
+                while (x < n && y < m && a[aStart + x] == b[bStart + y]) {
+                    ++x;
+                    ++y;
+                }
+                v[offset + k] = x;
+                if (x >= n && y >= m) {
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            result.append(DiffHunk { aStart, n, bOffset + bStart, m });
+            return result;
+        }
+        enum Operation { Equal, Delete, Insert };
+        QVector<Operation> script;
+        int x = n;
+        int y = m;
+        for (int d = trace.size() - 1; d >= 0; --d) {
+            const QVector<int>& previous = trace[d];
+            auto at = [&previous, d](int k) { return previous[k + d + 1]; };
+            int k = x - y;
+            int previousK = (k == -d || (k != d && at(k - 1) < at(k + 1))) ? k + 1 : k - 1;
+            int previousX = at(previousK);
+            int previousY = previousX - previousK;
+            while (x > previousX && y > previousY) {
+                script.append(Equal);
+                --x;
+                --y;
+            }
+            if (d > 0) script.append(x == previousX ? Insert : Delete);
+            x = previousX;
+            y = previousY;
+        }
+        std::reverse(script.begin(), script.end());
+        int ai = aStart;
+        int bi = bStart;
+        bool open = false;
+        for (Operation operation : script) {
+            if (operation == Equal) {
+                open = false;
+                ++ai;
+                ++bi;
+                continue;
+            }
+            if (!open) {
+                result.append(DiffHunk { ai, 0, bOffset + bi, 0 });
+                open = true;
+            }
+            if (operation == Delete) {
+                ++result.last().baseCount;
+                ++ai;
+            } else {
+                ++result.last().currentCount;
+                ++bi;
+            }
+        }
+        return result;
+    }
+private:
+    QStringList base;
+    QList<DiffHunk> hunks;
+};
+
+class GitChangeTracker : public QObject {
+    Q_OBJECT
+public:
+    GitChangeTracker(CodeEditor* codeEditor) : QObject(codeEditor), editor(codeEditor) {
+        publishTimer.setSingleShot(true);
+        publishTimer.setInterval(30);
+        connect(&publishTimer, &QTimer::timeout, this, &GitChangeTracker::publish);
+        connect(&watcher, &QFutureWatcherBase::finished, this, &GitChangeTracker::baselineLoaded);
+        connect(editor->document(), &QTextDocument::contentsChange, this, &GitChangeTracker::contentsChange);
+    }
+    ~GitChangeTracker() {
+        watcher.waitForFinished();
+    }
+    void load(const QString& filePath) {
+        ready = false;
+        published.clear();
+        editor->setGitChanges(QList<GutterRange>());
+        watcher.setFuture(QtConcurrent::run(&GitChangeTracker::readHead, filePath));
+    }
+    void setBaseline(const QStringList& lines) {
+        baseLines = lines;
+        blockCount = editor->document()->blockCount();
+        lineDiff.reset(baseLines, documentLines(0, blockCount));
+        ready = true;
+        publish();
+    }
+    const QList<DiffHunk>& changes() const { return published; }
+    static GitChangeTracker* forEditor(CodeEditor* editor) {
+        GitChangeTracker* tracker = editor->findChild<GitChangeTracker*>(QString(), Qt::FindDirectChildrenOnly);
+        return tracker ? tracker : new GitChangeTracker(editor);
+    }
+private:
+    struct Baseline {
+        bool valid = false;
+        QStringList lines;
+    };
+    CodeEditor* editor;
+    QStringList baseLines;
+    LineDiff lineDiff;
+    QList<DiffHunk> published;
+    bool ready = false;
+    int blockCount = 0;
+    QTimer publishTimer;
+    QFutureWatcher<Baseline> watcher;
+
+    static Baseline readHead(const QString& filePath) {
+        PAWNIX_TRACE("readHead", "git");
+        Baseline baseline;
+        QFileInfo info(filePath);
+        QProcess git;
+        git.setWorkingDirectory(info.absolutePath());
+        git.start("git", QStringList() << "show" << "HEAD:./" + info.fileName());
+        if (!git.waitForFinished(10000) || git.exitStatus() != QProcess::NormalExit || git.exitCode() != 0) return baseline;
+        QString text = SourceFile::decode(git.readAllStandardOutput());
+        text.remove('\r');
+        baseline.lines = text.split('\n');
+        baseline.valid = true;
+        return baseline;
+    }
+    QStringList documentLines(int from, int to) const {
+        QStringList lines;
+        for (QTextBlock block = editor->document()->findBlockByNumber(from); block.isValid() && block.blockNumber() < to; block = block.next()) {
+            lines << block.text();
+        }
+        return lines;
+    }
+    void baselineLoaded() {
+        Baseline baseline = watcher.result();
+        if (baseline.valid) setBaseline(baseline.lines);
+    }
+    void contentsChange(int position, int charsRemoved, int charsAdded) {
+        Q_UNUSED(charsRemoved);
+        if (!ready) return;
+        QTextDocument* document = editor->document();
+        QTextBlock firstBlock = document->findBlock(position);
+        QTextBlock lastBlock = document->findBlock(position + charsAdded);
+        int first = firstBlock.isValid() ? firstBlock.blockNumber() : document->blockCount() - 1;
+        int newEnd = (lastBlock.isValid() ? lastBlock.blockNumber() : document->blockCount() - 1) + 1;
+        int oldEnd = newEnd - (document->blockCount() - blockCount);
+        blockCount = document->blockCount();
+        if (oldEnd <= first) {
+            lineDiff.reset(baseLines, documentLines(0, blockCount));
+            publishTimer.start();
+            return;
+        }
+        lineDiff.update(first, oldEnd, newEnd, [this](int from, int to) { return documentLines(from, to); });
+        publishTimer.start();
+    }
+    void publish() {
+        if (lineDiff.changes() == published) return;
+        PAWNIX_TRACE("publishChanges", "git");
+        published = lineDiff.changes();
+        QList<GutterRange> ranges;
+        for (const DiffHunk& hunk : published) {
+            GutterRange range;
+            if (hunk.currentCount == 0) {
+                range.line = qMax(0, hunk.currentStart - 1);
+                range.color = QColor("#F14C4C");
+            } else {
+                range.line = hunk.currentStart;
+                range.count = hunk.currentCount;
+                range.color = hunk.baseCount == 0 ? QColor("#587C0C") : QColor("#1B81A8");
+            }
+            ranges.append(range);
+        }
+        editor->setGitChanges(ranges);
+    }
+};
+
+#endif
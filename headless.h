@@ -0,0 +1,307 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "includes.h"
+#include "buildpipeline.h"
+#include "symbolindex.h"
+#include "lint.h"
+#include "amx.h"
+#include "analysis.h"
+
+class HeadlessRunner {
+public:
+    enum ExitCode { Success = 0, Failed = 1, UsageError = 2, CompilerError = 3 };
+    static bool isHeadless(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            QByteArray arg(argv[i]);
+            if (arg == "--build" || arg == "--index" || arg == "--search" || arg == "--lint" || arg == "--help") return true;
+        }
+        return false;
+    }
+    HeadlessRunner(const QStringList& arguments) : args(arguments) {}
+    int run() {
+        QString mode;
+        QString workspace;
+        QString query;
+        for (int i = 1; i < args.size(); ++i) {
+            const QString& arg = args[i];
+            if (arg == "--help") return usage(true);
+            if (arg == "--build" || arg == "--index" || arg == "--search" || arg == "--lint") {
+                if (!mode.isEmpty() || i + 1 >= args.size()) return usage();
+                mode = arg.mid(2);
+                workspace = args[++i];
+                if (mode == "search") {
+                    if (i + 1 >= args.size()) return usage();
+                    query = args[++i];
+                }
+            } else if (arg == "--compiler" && i + 1 < args.size()) {
+                compilerPath = args[++i];
+            } else if (arg == "--include" && i + 1 < args.size()) {
+                extraIncludeDirs << QFileInfo(args[++i]).absoluteFilePath();
+            } else {
+                return usage();
+            }
+        }
+        if (mode.isEmpty()) return usage();
+        QFileInfo info(workspace);
+        if (!info.exists()) {
+            printError("workspace not found: " + workspace);
+            return UsageError;
+        }
+        root = info.isDir() ? info.absoluteFilePath() : info.absolutePath();
+        if (mode == "build") return build(info);
+        if (mode == "index") return index();
+        if (mode == "lint") return lint(info);
+        return search(query);
+    }
+    const QJsonObject& report() const { return lastReport; }
+private:
+    QStringList args;
+    QString compilerPath;
+    QStringList extraIncludeDirs;
+    QString root;
+    QJsonObject lastReport;
+
+    int usage(bool requested = false) {
+        QTextStream(requested ? stdout : stderr)
+            << "Usage:\n"
+            << "  PawniX --build <workspace|file.pwn> [--compiler <pawncc>] [--include <dir>]...\n"
+            << "  PawniX --index <workspace>\n"
+            << "  PawniX --search <workspace> <query>\n"
+            << "  PawniX --lint <workspace|file> [--include <dir>]...\n"
+            << "Exit codes: 0 success, 1 build errors, lint findings or no matches, 2 usage error, 3 compiler not found\n";
+        return requested ? Success : UsageError;
+    }
+    void print(const QJsonObject& object) {
+        lastReport = object;
+        QTextStream(stdout) << QJsonDocument(object).toJson(QJsonDocument::Indented);
+    }
+    void printError(const QString& message) {
+        QTextStream(stderr) << "PawniX: " << message << "\n";
+    }
+    QString findCompiler() const {
+        QStringList candidates;
+        candidates << compilerPath << qEnvironmentVariable("PAWNCC")
+                   << QSettings("kahendrik", "PawniX").value("compilerPath").toString();
+        for (const QString& dir : { root + "/pawno", root + "/qawno", QCoreApplication::applicationDirPath() + "/pawno" }) {
+            candidates << dir + "/pawncc.exe" << dir + "/pawncc";
+        }
+        for (const QString& candidate : candidates) {
+            if (!candidate.isEmpty() && QFileInfo(candidate).isFile()) {
+                return QFileInfo(candidate).absoluteFilePath();
+            }
+        }
+        return QString();
+    }
+    QStringList buildSources(const QFileInfo& target) const {
+        if (target.isFile()) return QStringList() << target.absoluteFilePath();
+        QStringList sources;
+        for (const QString& dir : { QString("gamemodes"), QString("filterscripts") }) {
+            for (const QFileInfo& file : QDir(root + "/" + dir).entryInfoList(QStringList() << "*.pwn", QDir::Files, QDir::Name)) {
+                sources << file.absoluteFilePath();
+            }
+        }
+        if (sources.isEmpty()) {
+            for (const QFileInfo& file : QDir(root).entryInfoList(QStringList() << "*.pwn", QDir::Files, QDir::Name)) {
+                sources << file.absoluteFilePath();
+            }
+        }
+        return sources;
+    }
+    int build(const QFileInfo& target) {
+        QString compiler = findCompiler();
+        if (compiler.isEmpty()) {
+            printError("pawn compiler not found; use --compiler or the PAWNCC environment variable");
+            return CompilerError;
+        }
+        QStringList sources = buildSources(target);
+        if (sources.isEmpty()) {
+            printError("no .pwn sources in " + root);
+            return UsageError;
+        }
+        QStringList workspaceIncludeDirs = this->workspaceIncludeDirs();
+        IncludeGraph graph;
+        IncludeResolver resolver;
+        QJsonArray results;
+        int exitCode = Success;
+        for (const QString& source : sources) {
+            CompileRequest request = CompileRequest::forSource(compiler, source);
+            for (const QString& dir : workspaceIncludeDirs) {
+                if (!request.includeDirs.contains(dir)) request.includeDirs << dir;
+            }
+            CompileResult result = runCompile(request);
+            QJsonObject entry;
+            entry["source"] = source;
+            entry["output"] = QDir(request.workingDir).filePath(request.outputFile);
+            entry["started"] = result.started;
+            entry["exitCode"] = result.exitCode;
+            entry["success"] = result.success();
+            entry["elapsedMs"] = result.elapsedMs;
+            QJsonArray includes;
+            for (const QString& include : graph.closure(source, request.includeDirs)) {
+                if (include != source) includes.append(include);
+            }
+            entry["includes"] = includes;
+            QJsonArray diagnostics;
+            for (const Diagnostic& diagnostic : result.diagnostics) {
+                diagnostics.append(diagnostic.toJson());
+            }
+            entry["diagnostics"] = diagnostics;
+            if (result.success()) {
+                AmxInfo amx = AmxInfo::read(QDir(request.workingDir).filePath(request.outputFile));
+                if (amx.valid) entry["amx"] = amx.toJson();
+            }
+            QString text;
+            if (SourceFile::read(source, text)) {
+                AnalysisResult context;
+                context.symbols = SymbolParser::parse(text, source);
+                resolver.resolve(DocumentSnapshot { 0, 0, source, text }, context, request.includeDirs);
+                entry["lint"] = diagnosticsJson(LintRegistry::defaults().run(source, text, context.symbols, context.includeMacros).diagnostics);
+            }
+            results.append(entry);
+            if (!result.started) {
+                exitCode = CompilerError;
+            } else if (!result.success() && exitCode == Success) {
+                exitCode = Failed;
+            }
+        }
+        QJsonObject report;
+        report["command"] = "build";
+        report["workspace"] = root;
+        report["compiler"] = compiler;
+        report["success"] = exitCode == Success;
+        report["results"] = results;
+        print(report);
+        return exitCode;
+    }
+    QStringList workspaceIncludeDirs() const {
+        QStringList dirs = extraIncludeDirs;
+        for (const QString& dir : { root + "/pawno/include", root + "/qawno/include", root + "/include" }) {
+            if (QDir(dir).exists()) dirs << dir;
+        }
+        return dirs;
+    }
+    CompileResult runCompile(const CompileRequest& request) {
+        CompileResult result;
+        bool done = false;
+        QEventLoop loop;
+        CompileJob job(request);
+        QObject::connect(&job, &CompileJob::finished, &loop, [&](const CompileResult& finished) {
+            result = finished;
+            done = true;
+            loop.quit();
+        });
+        job.start();
+        if (!done) loop.exec();
+        return result;
+    }
+    static QJsonArray diagnosticsJson(const QList<Diagnostic>& diagnostics) {
+        QJsonArray array;
+        for (const Diagnostic& diagnostic : diagnostics) {
+            array.append(diagnostic.toJson());
+        }
+        return array;
+    }
+    int lint(const QFileInfo& target) {
+        QElapsedTimer timer;
+        timer.start();
+        QStringList files = target.isFile() ? QStringList() << target.absoluteFilePath() : SymbolIndex::workspaceFiles(root);
+        LintRegistry registry = LintRegistry::defaults();
+        QStringList workspaceIncludeDirs = this->workspaceIncludeDirs();
+        IncludeResolver resolver;
+        QMutex resolverMutex;
+        QList<LintReport> reports = QtConcurrent::blockingMapped(files, [&](const QString& file) {
+            QString text;
+            if (!SourceFile::read(file, text)) return LintReport();
+            AnalysisResult context;
+            context.symbols = SymbolParser::parse(text, file);
+            QStringList includeDirs = CompileRequest::forSource(QString(), file).includeDirs;
+            for (const QString& dir : workspaceIncludeDirs) {
+                if (!includeDirs.contains(dir)) includeDirs << dir;
+            }
+            {
+                QMutexLocker locker(&resolverMutex);
+                resolver.resolve(DocumentSnapshot { 0, 0, file, text }, context, includeDirs);
+            }
+            return registry.run(file, text, context.symbols, context.includeMacros);
+        });
+        QJsonArray fileEntries;
+        QHash<QString, LintTiming> totals;
+        int findingCount = 0;
+        for (int i = 0; i < files.size(); ++i) {
+            for (const LintTiming& timing : reports[i].timings) {
+                LintTiming& total = totals[timing.rule];
+                total.rule = timing.rule;
+                total.findings += timing.findings;
+                total.elapsedNs += timing.elapsedNs;
+            }
+            if (reports[i].diagnostics.isEmpty()) continue;
+            findingCount += reports[i].diagnostics.size();
+            QJsonObject entry;
+            entry["file"] = files[i];
+            entry["diagnostics"] = diagnosticsJson(reports[i].diagnostics);
+            fileEntries.append(entry);
+        }
+        QJsonArray rules;
+        for (const QString& id : registry.ruleIds()) {
+            QJsonObject rule;
+            rule["id"] = id;
+            rule["findings"] = totals.value(id).findings;
+            rule["elapsedMs"] = totals.value(id).elapsedNs / 1e6;
+            rules.append(rule);
+        }
+        QJsonObject report;
+        report["command"] = "lint";
+        report["workspace"] = root;
+        report["fileCount"] = files.size();
+        report["findingCount"] = findingCount;
+        report["elapsedMs"] = timer.elapsed();
+        report["rules"] = rules;
+        report["files"] = fileEntries;
+        print(report);
+        return findingCount > 0 ? Failed : Success;
+    }
+    int index() {
+        QElapsedTimer timer;
+        timer.start();
+        SymbolIndex symbolIndex;
+        symbolIndex.indexFiles(SymbolIndex::workspaceFiles(root));
+        QJsonArray files;
+        for (const QString& file : symbolIndex.files()) {
+            QJsonArray symbols;
+            for (const SymbolInfo& symbol : symbolIndex.symbolsInFile(file)) {
+                symbols.append(symbol.toJson());
+            }
+            QJsonObject entry;
+            entry["file"] = file;
+            entry["symbols"] = symbols;
+            files.append(entry);
+        }
+        QJsonObject report;
+        report["command"] = "index";
+        report["workspace"] = root;
+        report["fileCount"] = symbolIndex.fileCount();
+        report["symbolCount"] = symbolIndex.symbolCount();
+        report["elapsedMs"] = timer.elapsed();
+        report["files"] = files;
+        print(report);
+        return Success;
+    }
+    int search(const QString& query) {
+        SymbolIndex symbolIndex;
+        symbolIndex.indexFiles(SymbolIndex::workspaceFiles(root));
+        QJsonArray matches;
+        for (const SymbolInfo& symbol : symbolIndex.search(query)) {
+            matches.append(symbol.toJson());
+        }
+        QJsonObject report;
+        report["command"] = "search";
+        report["workspace"] = root;
+        report["query"] = query;
+        report["matches"] = matches;
+        print(report);
+        return matches.isEmpty() ? Failed : Success;
+    }
+};
+
+#endif
@@ -55,5 +55,38 @@
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
 #include <QFileSystemModel>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDateTime>
+#include <QSet>
+#include <QDirIterator>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtConcurrent>
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QSysInfo>
+#include <QMutex>
+#include <QThread>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QPointer>
+#include <QFutureWatcher>
+#include <QTableWidget>
+#include <QTreeWidget>
+#include <QToolTip>
+#include <QHelpEvent>
+#include <QtEndian>
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QListView>
+#include <QLineEdit>
+#include <QMouseEvent>
+#include <QImage>
+#include <QVarLengthArray>
 
 #endif
@@ -0,0 +1,233 @@
+#ifndef LINT_H
+#define LINT_H
+
+#include "includes.h"
+#include "pawnlexer.h"
+#include "preprocessor.h"
+#include "symbolindex.h"
+#include "buildpipeline.h"
+#include "trace.h"
+
+class LintContext {
+public:
+    LintContext(const QString& filePath, const QString& source, const QList<SymbolInfo>& fileSymbols,
+                const QHash<QString, MacroTable>& includeMacros = QHash<QString, MacroTable>())
+        : file(filePath), text(source), symbols(fileSymbols),
+          tokens(PawnLexer::tokenize(source)), macros(PreprocessorModel::collectMacros(source)) {
+        for (const MacroTable& table : includeMacros) {
+            for (auto it = table.constBegin(); it != table.constEnd(); ++it) {
+                if (!macros.contains(it.key())) macros.insert(it.key(), it.value());
+            }
+        }
+        depths.resize(tokens.size());
+        int depth = 0;
+        for (int i = 0; i < tokens.size(); ++i) {
+            if (isOperator(i, '}')) depth = qMax(0, depth - 1);
+            depths[i] = depth;
+            if (isOperator(i, '{')) ++depth;
+        }
+    }
+    QString file;
+    const QString& text;
+    const QList<SymbolInfo>& symbols;
+    QVector<PawnToken> tokens;
+    MacroTable macros;
+    QVector<int> depths;
+
+    QStringView tokenText(int index) const {
+        const PawnToken& token = tokens[index];
+        return QStringView(text).mid(token.start, token.length);
+    }
+    bool isIdentifier(int index, QStringView name) const {
+        return index >= 0 && index < tokens.size() && tokens[index].kind == PawnToken::Identifier && tokenText(index) == name;
+    }
+    bool isOperator(int index, QChar c) const {
+        return index >= 0 && index < tokens.size() && tokens[index].kind == PawnToken::Operator && text[tokens[index].start] == c;
+    }
+    int matching(int open) const {
+        QChar openChar = text[tokens[open].start];
+        QChar closeChar = openChar == '(' ? ')' : openChar == '[' ? ']' : '}';
+        int depth = 0;
+        for (int i = open; i < tokens.size(); ++i) {
+            if (isOperator(i, openChar)) ++depth;
+            else if (isOperator(i, closeChar) && --depth == 0) return i;
+        }
+        return -1;
+    }
+    bool isCall(int index, QStringView name) const {
+        return isIdentifier(index, name) && isOperator(index + 1, '(');
+    }
+    Diagnostic finding(int index, const QString& message) const {
+        Diagnostic diagnostic;
+        diagnostic.file = file;
+        diagnostic.line = tokens[index].line + 1;
+        diagnostic.endLine = diagnostic.line;
+        diagnostic.severity = Diagnostic::Warning;
+        diagnostic.message = message;
+        diagnostic.source = "lint";
+        return diagnostic;
+    }
+};
+
+struct LintRule {
+    QString id;
+    int code;
+    std::function<void(const LintContext&, QList<Diagnostic>&)> check;
+};
+
+struct LintTiming {
+    QString rule;
+    int findings = 0;
+    qint64 elapsedNs = 0;
+};
+
+struct LintReport {
+    QList<Diagnostic> diagnostics;
+    QList<LintTiming> timings;
+    qint64 elapsedNs = 0;
+};
+
+class LintRegistry {
+public:
+    void registerRule(const LintRule& rule) {
+        rules.append(rule);
+    }
+    QStringList ruleIds() const {
+        QStringList ids;
+        for (const LintRule& rule : rules) ids << rule.id;
+        return ids;
+    }
+    LintReport run(const QString& filePath, const QString& text, const QList<SymbolInfo>& symbols,
+                   const QHash<QString, MacroTable>& includeMacros = QHash<QString, MacroTable>()) const {
+        PAWNIX_TRACE("lint", "lint");
+        LintReport report;
+        QElapsedTimer total;
+        total.start();
+        LintContext context(filePath, text, symbols, includeMacros);
+        for (const LintRule& rule : rules) {
+            QElapsedTimer timer;
+            timer.start();
+            QList<Diagnostic> findings;
+            rule.check(context, findings);
+            for (Diagnostic& diagnostic : findings) {
+                diagnostic.code = rule.code;
+            }
+            report.timings.append(LintTiming { rule.id, int(findings.size()), timer.nsecsElapsed() });
+            report.diagnostics.append(findings);
+        }
+        report.elapsedNs = total.nsecsElapsed();
+        return report;
+    }
+    static LintRegistry defaults() {
+        LintRegistry registry;
+        registry.registerRule(LintRule { "strlen-in-loop-condition", 1001, &checkStrlenInLoop });
+        registry.registerRule(LintRule { "expensive-call-in-onplayerupdate", 1002, &checkPlayerUpdateCalls });
+        registry.registerRule(LintRule { "max-players-loop", 1003, &checkMaxPlayersLoop });
+        registry.registerRule(LintRule { "large-local-array", 1004, &checkLargeLocalArrays });
+        return registry;
+    }
+private:
+    QList<LintRule> rules;
+
+    static int conditionEnd(const LintContext& context, int open, int& conditionStart) {
+        int close = context.matching(open);
+        if (close < 0) return -1;
+        conditionStart = open + 1;
+        if (!context.isIdentifier(open - 1, u"for")) return close;
+        int semicolons = 0;
+        for (int i = open + 1; i < close; ++i) {
+            if (!context.isOperator(i, ';')) continue;
+            if (++semicolons == 1) {
+                conditionStart = i + 1;
+            } else {
+                return i;
+            }
+        }
+        return semicolons == 1 ? close : -1;
+    }
+    static void checkStrlenInLoop(const LintContext& context, QList<Diagnostic>& findings) {
+        for (int i = 0; i + 1 < context.tokens.size(); ++i) {
+            if (!(context.isIdentifier(i, u"for") || context.isIdentifier(i, u"while")) || !context.isOperator(i + 1, '(')) continue;
+            int start = 0;
+            int end = conditionEnd(context, i + 1, start);
+            for (int j = start; j < end; ++j) {
+                if (context.isCall(j, u"strlen")) {
+                    findings.append(context.finding(j, "strlen() в условии цикла вычисляется на каждой итерации; сохраните длину в переменную до цикла"));
+                    break;
+                }
+            }
+        }
+    }
+    static void checkPlayerUpdateCalls(const LintContext& context, QList<Diagnostic>& findings) {
+        static const QStringList expensive { "format", "SendClientMessageToAll", "GameTextForAll", "printf" };
+        for (const SymbolInfo& symbol : context.symbols) {
+            if (symbol.name != "OnPlayerUpdate" || !symbol.isFunction() || !symbol.definition) continue;
+            for (int i = 0; i < context.tokens.size(); ++i) {
+                int line = context.tokens[i].line;
+                if (line < symbol.line || line > symbol.endLine || context.tokens[i].kind != PawnToken::Identifier) continue;
+                for (const QString& name : expensive) {
+                    if (context.isCall(i, name)) {
+                        findings.append(context.finding(i, name + "() в OnPlayerUpdate вызывается десятки раз в секунду на каждого игрока; "
+                                                               "вынесите его в таймер или обработчик события"));
+                    }
+                }
+            }
+        }
+    }
+    static void checkMaxPlayersLoop(const LintContext& context, QList<Diagnostic>& findings) {
+        for (int i = 0; i + 1 < context.tokens.size(); ++i) {
+            if (!context.isIdentifier(i, u"for") || !context.isOperator(i + 1, '(')) continue;
+            int start = 0;
+            int end = conditionEnd(context, i + 1, start);
+            for (int j = start; j < end; ++j) {
+                if (context.isIdentifier(j, u"MAX_PLAYERS")) {
+                    findings.append(context.finding(j, "Цикл до MAX_PLAYERS перебирает все слоты; используйте GetPlayerPoolSize() или foreach"));
+                    break;
+                }
+            }
+        }
+    }
+    static void checkLargeLocalArrays(const LintContext& context, QList<Diagnostic>& findings) {
+        const int limit = 1024;
+        for (int i = 0; i < context.tokens.size(); ++i) {
+            if (!context.isIdentifier(i, u"new") || context.depths[i] == 0 || context.isIdentifier(i + 1, u"static")) continue;
+            int j = i + 1;
+            while (j < context.tokens.size() && !context.isOperator(j, ';')) {
+                if (context.isIdentifier(j, u"const")) ++j;
+                if (j < context.tokens.size() && context.tokens[j].kind == PawnToken::Identifier && context.isOperator(j + 1, ':')) j += 2;
+                int name = j;
+                if (name >= context.tokens.size() || context.tokens[name].kind != PawnToken::Identifier) break;
+                ++j;
+                qint64 cells = 1;
+                bool array = false;
+                while (context.isOperator(j, '[')) {
+                    int close = context.matching(j);
+                    if (close < 0) return;
+                    int from = context.tokens[j].start + 1;
+                    QString size = context.text.mid(from, context.tokens[close].start - from);
+                    qint64 value = size.trimmed().isEmpty() ? 0 : ExpressionEvaluator::evaluate(size, context.macros);
+                    cells = value > 0 ? cells * value : 0;
+                    array = true;
+                    j = close + 1;
+                }
+                if (array && cells > limit) {
+                    findings.append(context.finding(name, QString("Локальный массив %1 занимает %2 ячеек (%3 КБ) стека; "
+                                                                  "сделайте его static или глобальным")
+                                                              .arg(context.tokenText(name)).arg(cells).arg(cells * 4 / 1024)));
+                }
+                while (j < context.tokens.size() && !context.isOperator(j, ',') && !context.isOperator(j, ';')) {
+                    if (context.isOperator(j, '(') || context.isOperator(j, '[') || context.isOperator(j, '{')) {
+                        int close = context.matching(j);
+                        if (close < 0) return;
+                        j = close;
+                    }
+                    ++j;
+                }
+                if (context.isOperator(j, ',')) ++j;
+            }
+            i = j;
+        }
+    }
+};
+
+#endif
@@ -1,236 +1,19 @@
 #include <includes.h>
+#include "buildpipeline.h"
+#include "headless.h"
+#include "codeeditor.h"
+#include "sourcefile.h"
+#include "trace.h"
+#include "settingsstore.h"
+#include "analysis.h"
+#include "workspaceindex.h"
+#include "refactoring.h"
+#include "amx.h"
+#include "profile.h"
+#include "servertarget.h"
+#include "gitdiff.h"
 class CodeEditor;
 class PawnEditor;
-class PawnHighlighter : public QSyntaxHighlighter {
-public:
-    PawnHighlighter(QTextDocument* parent = nullptr) : QSyntaxHighlighter(parent) {
-        setupRules();
-    }
-private:
-    struct HighlightRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightRule> rules;
-    QTextCharFormat multiLineCommentFormat;
-    void setupRules() {
-        std::vector<std::string> keywords = {
-            "assert", "break", "case", "const", "continue", "default", "do", "else", "enum", "for",
-            "forward", "functag", "goto", "if", "native", "new", "operator", "public", "return",
-            "sizeof", "static", "stock", "switch", "tagof", "while", "defined"
-        };
-        QTextCharFormat keywordFormat;
-        keywordFormat.setForeground(QColor("#569CD6"));
-        keywordFormat.setFontWeight(QFont::Bold);
-        for (const std::string& keyword : keywords) {
-            HighlightRule rule;
-            rule.pattern = QRegularExpression("\\b" + QString::fromStdString(keyword) + "\\b");
-            rule.format = keywordFormat;
-            rules.append(rule);
-        }
-        QTextCharFormat preprocessorFormat;
-        preprocessorFormat.setForeground(QColor("#C586C0"));
-        HighlightRule preprocessorRule;
-        preprocessorRule.pattern = QRegularExpression("#\\s*\\w+");
-        preprocessorRule.format = preprocessorFormat;
-        rules.append(preprocessorRule);
-        QTextCharFormat stringFormat;
-        stringFormat.setForeground(QColor("#CE9178"));
-        HighlightRule stringRule;
-        stringRule.pattern = QRegularExpression("\".*?\"");
-        stringRule.format = stringFormat;
-        rules.append(stringRule);
-        QTextCharFormat numberFormat;
-        numberFormat.setForeground(QColor("#B5CEA8"));
-        HighlightRule numberRule;
-        numberRule.pattern = QRegularExpression("\\b\\d+\\b");
-        numberRule.format = numberFormat;
-        rules.append(numberRule);
-        QTextCharFormat commentFormat;
-        commentFormat.setForeground(QColor("#6A9955"));
-        HighlightRule commentRule;
-        commentRule.pattern = QRegularExpression("//[^\\n]*");
-        commentRule.format = commentFormat;
-        rules.append(commentRule);
-        multiLineCommentFormat = commentFormat;
-        multiLineCommentFormat.setForeground(QColor("#6A9955"));
-    }
-    void highlightBlock(const QString& text) override {
-        for (const HighlightRule& rule : rules) {
-            QRegularExpressionMatchIterator it = rule.pattern.globalMatch(text);
-            while (it.hasNext()) {
-                QRegularExpressionMatch match = it.next();
-                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-            }
-        }
-        setCurrentBlockState(0);
-        int startIndex = 0;
-        if (previousBlockState() != 1) {
-            startIndex = text.indexOf("/*");
-        }
-        while (startIndex >= 0) {
-            int endIndex = text.indexOf("*/", startIndex);
-            int commentLength;
-            if (endIndex == -1) {
-                setCurrentBlockState(1);
-                commentLength = text.length() - startIndex;
-            } else {
-                commentLength = endIndex - startIndex + 2;
-            }
-            setFormat(startIndex, commentLength, multiLineCommentFormat);
-            startIndex = text.indexOf("/*", startIndex + commentLength);
-        }
-    }
-};
-class CodeEditor : public QPlainTextEdit {
-    Q_OBJECT
-public:
-    CodeEditor(QWidget* parent = nullptr) : QPlainTextEdit(parent) {
-        QFont font;
-        font.setFamily("Consolas");
-        font.setPointSize(12);
-        setFont(font);
-        QPalette p = palette();
-        p.setColor(QPalette::Base, QColor("#1E1E1E"));
-        p.setColor(QPalette::Text, QColor("#D4D4D4"));
-        p.setColor(QPalette::Highlight, QColor("#264F78"));
-        p.setColor(QPalette::HighlightedText, Qt::white);
-        setPalette(p);
-        new PawnHighlighter(document());
-        setTabStopDistance(4 * fontMetrics().horizontalAdvance(' '));
-        connect(this, &CodeEditor::blockCountChanged, this, &CodeEditor::updateLineNumberAreaWidth);
-        connect(this, &CodeEditor::updateRequest, this, &CodeEditor::updateLineNumberArea);
-        connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
-        lineNumberArea = new LineNumberArea(this);
-        updateLineNumberAreaWidth(0);
-        highlightCurrentLine();
-    }
-    int lineNumberAreaWidth() {
-        int digits = 1;
-        int max = qMax(1, blockCount());
-        while (max >= 10) {
-            max /= 10;
-            ++digits;
-        }
-        return 10 + fontMetrics().horizontalAdvance('9') * digits;
-    }
-    void lineNumberAreaPaintEvent(QPaintEvent *event) {
-        QPainter painter(lineNumberArea);
-        painter.fillRect(event->rect(), QColor("#252526"));
-        QTextBlock block = firstVisibleBlock();
-        int blockNumber = block.blockNumber();
-        int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
-        int bottom = top + (int)blockBoundingRect(block).height();
-        while (block.isValid() && top <= event->rect().bottom()) {
-            if (block.isVisible() && bottom >= event->rect().top()) {
-                QString number = QString::number(blockNumber + 1);
-                painter.setPen(QColor("#7A7A7A"));
-                painter.drawText(0, top, lineNumberArea->width() - 5, fontMetrics().height(),
-                                 Qt::AlignRight, number);
-            }
-            block = block.next();
-            top = bottom;
-            bottom = top + (int)blockBoundingRect(block).height();
-            ++blockNumber;
-        }
-    }
-    void findText(const QString& text, bool caseSensitive, bool wholeWords) {
-        QTextDocument* doc = document();
-        QTextCursor cursor(doc);
-        QTextCursor highlightCursor(doc);
-        QTextCharFormat fmt;
-        fmt.setBackground(Qt::yellow);
-        QList<QTextEdit::ExtraSelection> selections;
-        setExtraSelections(selections);
-        if (text.isEmpty()) return;
-        QRegularExpression pattern(text);
-        pattern.setPatternOptions(wholeWords ? QRegularExpression::UseUnicodePropertiesOption | QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
-        if (caseSensitive) pattern.setPatternOptions(pattern.patternOptions() ^ QRegularExpression::CaseInsensitiveOption);
-        while (!cursor.isNull() && cursor.movePosition(QTextCursor::NextBlock)) {
-            QRegularExpressionMatchIterator it = pattern.globalMatch(cursor.block().text());
-            while (it.hasNext()) {
-                QRegularExpressionMatch match = it.next();
-                highlightCursor.setPosition(cursor.block().position() + match.capturedStart());
-                highlightCursor.setPosition(cursor.block().position() + match.capturedEnd(), QTextCursor::KeepAnchor);
-                QTextEdit::ExtraSelection selection;
-                selection.cursor = highlightCursor;
-                selection.format = fmt;
-                selections.append(selection);
-            }
-        }
-        setExtraSelections(selections);
-    }
-    void replaceText(const QString& searchText, const QString& replaceText, bool caseSensitive, bool wholeWords) {
-        QTextCursor cursor(document());
-        int count = 0;
-        QRegularExpression pattern(searchText);
-        pattern.setPatternOptions(wholeWords ? QRegularExpression::UseUnicodePropertiesOption | QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
-        if (caseSensitive) pattern.setPatternOptions(pattern.patternOptions() ^ QRegularExpression::CaseInsensitiveOption);
-        while (!cursor.isNull() && cursor.movePosition(QTextCursor::NextBlock)) {
-            QRegularExpressionMatchIterator it = pattern.globalMatch(cursor.block().text());
-            while (it.hasNext()) {
-                QRegularExpressionMatch match = it.next();
-                cursor.setPosition(cursor.block().position() + match.capturedStart());
-                cursor.setPosition(cursor.block().position() + match.capturedEnd(), QTextCursor::KeepAnchor);
-                cursor.insertText(replaceText);
-                count++;
-            }
-        }
-        if (count > 0) {
-            QTextCursor tc = textCursor();
-            tc.movePosition(QTextCursor::Start);
-            setTextCursor(tc);
-        }
-    }
-    void goToLine(int lineNumber) {
-        if (lineNumber < 1 || lineNumber > blockCount()) return;
-        QTextCursor cursor(document()->findBlockByNumber(lineNumber - 1));
-        cursor.movePosition(QTextCursor::StartOfLine);
-        setTextCursor(cursor);
-        verticalScrollBar()->setValue(cursor.position());
-    }
-protected:
-    void resizeEvent(QResizeEvent *event) override {
-        QPlainTextEdit::resizeEvent(event);
-        QRect cr = contentsRect();
-        lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
-    }
-private slots:
-    void updateLineNumberAreaWidth(int newBlockCount) {
-        Q_UNUSED(newBlockCount);
-        setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
-    }
-    void updateLineNumberArea(const QRect& rect, int dy) {
-        if (dy)
-            lineNumberArea->scroll(0, dy);
-        else
-            lineNumberArea->update(0, rect.y(), lineNumberArea->width(), rect.height());
-    }
-    void highlightCurrentLine() {
-        QList<QTextEdit::ExtraSelection> extraSelections;
-        if (!isReadOnly()) {
-            QTextEdit::ExtraSelection selection;
-            selection.format.setBackground(QColor("#2D2D30"));
-            selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-            selection.cursor = textCursor();
-            selection.cursor.clearSelection();
-            extraSelections.append(selection);
-        }
-        setExtraSelections(extraSelections);
-    }
-private:
-    class LineNumberArea : public QWidget {
-    public:
-        LineNumberArea(CodeEditor *editor) : QWidget(editor), codeEditor(editor) {}
-    protected:
-        void paintEvent(QPaintEvent *event) override {
-            codeEditor->lineNumberAreaPaintEvent(event);
-        }
-    private:
-        CodeEditor *codeEditor;
-    };
-    LineNumberArea *lineNumberArea;
-};
 class FindDialog : public QDialog {
     Q_OBJECT
 public:
@@ -303,6 +86,51 @@ private:
     QLineEdit* replaceEdit;
     QPushButton* replaceAllButton;
 };
+class RenamePreviewDialog : public QDialog {
+public:
+    RenamePreviewDialog(const QString& title, QWidget* parent = nullptr) : QDialog(parent) {
+        QVBoxLayout* layout = new QVBoxLayout(this);
+        summaryLabel = new QLabel();
+        changesTree = new QTreeWidget();
+        changesTree->setHeaderHidden(true);
+        changesTree->setStyleSheet("QTreeWidget { background: #252526; color: #D4D4D4; }");
+        QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+        buttonBox->button(QDialogButtonBox::Ok)->setText("Переименовать");
+        connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+        connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+        layout->addWidget(summaryLabel);
+        layout->addWidget(changesTree);
+        layout->addWidget(buttonBox);
+        setWindowTitle(title);
+        resize(700, 450);
+    }
+    void addFile(const QString& label, const QString& filePath, int count, const QStringList& previews) {
+        QTreeWidgetItem* fileItem = new QTreeWidgetItem(changesTree, QStringList() << QString("%1 (%2)").arg(label).arg(count));
+        fileItem->setData(0, Qt::UserRole, filePath);
+        fileItem->setFlags(fileItem->flags() | Qt::ItemIsUserCheckable);
+        fileItem->setCheckState(0, Qt::Checked);
+        for (int i = 0; i < previews.size() && i < 200; ++i) {
+            new QTreeWidgetItem(fileItem, QStringList() << previews[i]);
+        }
+        if (previews.size() > 200) {
+            new QTreeWidgetItem(fileItem, QStringList() << QString("... ещё %1").arg(previews.size() - 200));
+        }
+        total += count;
+        summaryLabel->setText(QString("Вхождений: %1, файлов: %2").arg(total).arg(changesTree->topLevelItemCount()));
+    }
+    QSet<QString> selectedFiles() const {
+        QSet<QString> files;
+        for (int i = 0; i < changesTree->topLevelItemCount(); ++i) {
+            QTreeWidgetItem* item = changesTree->topLevelItem(i);
+            if (item->checkState(0) == Qt::Checked) files.insert(item->data(0, Qt::UserRole).toString());
+        }
+        return files;
+    }
+private:
+    QLabel* summaryLabel;
+    QTreeWidget* changesTree;
+    int total = 0;
+};
 class StartPage : public QWidget {
     Q_OBJECT
 public:
@@ -369,6 +197,20 @@ void StartPage::updateRecentFiles(const QStringList &files) {
         recentList->addItem(item);
     }
 }
+struct MacroExpansionReport {
+    struct Function {
+        QString name;
+        int line = 0;
+        int tokensBefore = 0;
+        int tokensAfter = 0;
+    };
+    QString expanded;
+    int firstLine = 0;
+    int tokensBefore = 0;
+    int tokensAfter = 0;
+    int substitutions = 0;
+    QList<Function> functions;
+};
 class PawnEditor : public QMainWindow {
     Q_OBJECT
 public:
@@ -381,6 +223,33 @@ public:
         editorTab = new QTabWidget();
         editorTab->setTabsClosable(true);
         stackedWidget->addWidget(editorTab);
+        settingsStore = new SettingsStore("kahendrik", "PawniX", this);
+        stallDetector = new StallDetector(this);
+        analysisService = new AnalysisService(this);
+        workspaceIndex = new WorkspaceIndex(this);
+        serverProcess = new ServerProcess(this);
+        connect(serverProcess, &ServerProcess::linesReady, this, &PawnEditor::appendServerLines);
+        connect(serverProcess, &ServerProcess::stopped, this, [this](int exitCode, const QString& error) {
+            QString message = error.isEmpty() ? QString("Сервер остановлен, код выхода %1").arg(exitCode)
+                                              : "Сервер остановлен: " + error;
+            appendServerLines({ LogLine { message, error.isEmpty() ? LogLine::Normal : LogLine::Error, QString(), -1 } });
+            statusBar()->showMessage(message, 3000);
+        });
+        connect(workspaceIndex, &WorkspaceIndex::indexed, this, [this](int fileCount, int changedCount) {
+            statusBar()->showMessage(QString("Индекс обновлён: файлов %1, изменено %2").arg(fileCount).arg(changedCount), 3000);
+        });
+        connect(analysisService, &AnalysisService::resultReady, this, &PawnEditor::indexAnalysis);
+        connect(analysisService, &AnalysisService::resultReady, this, &PawnEditor::applyAnalysis);
+        macroWatcher = new QFutureWatcher<MacroExpansionReport>(this);
+        connect(macroWatcher, &QFutureWatcherBase::finished, this, [this]() {
+            showMacroExpansion(macroWatcher->result());
+        });
+        watchTimer = new QTimer(this);
+        watchTimer->setSingleShot(true);
+        watchTimer->setInterval(700);
+        connect(watchTimer, &QTimer::timeout, this, [this]() {
+            startBuild(watchFile, true);
+        });
         loadSettings();
         if (pawnccPath.isEmpty()) {
             findPawnCompiler(false);
@@ -388,13 +257,27 @@ public:
         createMenus();
         createToolBars();
         statusBar()->showMessage("Готово");
-        if (!pawnccPath.isEmpty()) {
-            statusBar()->addPermanentWidget(new QLabel("Компилятор: " + pawnccPath));
-        }
+        compilerLabel = new QLabel(pawnccPath.isEmpty() ? QString() : "Компилятор: " + pawnccPath);
+        statusBar()->addPermanentWidget(compilerLabel);
+        buildStatusLabel = new QLabel();
+        statusBar()->addPermanentWidget(buildStatusLabel);
+        lintLabel = new QLabel();
+        statusBar()->addPermanentWidget(lintLabel);
         createDockWidgets();
         setupCompleter();
         connect(editorTab, &QTabWidget::tabCloseRequested, this, &PawnEditor::closeTab);
-        connect(editorTab, &QTabWidget::currentChanged, this, &PawnEditor::updateWindowTitle);
+        connect(editorTab, &QTabWidget::currentChanged, this, [this]() {
+            CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+            if (currentEditor && !currentEditor->filePath().isEmpty()) {
+                currentFile = currentEditor->filePath();
+            }
+            if (currentEditor && analysisService->hasResult(currentEditor->document())) {
+                applyAnalysis(analysisService->result(currentEditor->document()));
+            } else {
+                outlineList->clear();
+            }
+            updateWindowTitle();
+        });
         connect(startPage, &StartPage::createNewFile, this, &PawnEditor::newFile);
         connect(startPage, &StartPage::openFile, this, &PawnEditor::open);
         connect(startPage, &StartPage::openFolder, this, &PawnEditor::openFolder);
@@ -405,9 +288,14 @@ public:
         } else {
             stackedWidget->setCurrentIndex(1);
         }
+        restoreSession();
+        workspaceIndex->indexWorkspace(currentFolder);
     }
     ~PawnEditor() {
         saveSettings();
+        settingsStore->setValue("geometry", saveGeometry());
+        settingsStore->setValue("windowState", saveState());
+        settingsStore->sync();
     }
 private:
     QTabWidget* editorTab;
@@ -420,7 +308,51 @@ private:
     QFileSystemModel* fsModel;
     QTreeView* fileTree;
     QTextEdit* errorConsole = nullptr;
-    QProcess* pawnProcess = nullptr;
+    QDockWidget* consoleDock = nullptr;
+    CompileJob* compileJob = nullptr;
+    CompileJob* listingJob = nullptr;
+    CompileRequest listingRequest;
+    AmxInfo listingInfo;
+    AmxInfo listingPrevious;
+    bool listingPending = false;
+    QHash<QString, AmxInfo> amxReports;
+    QDockWidget* amxDock = nullptr;
+    QLabel* amxSummary;
+    QTableWidget* amxTable;
+    QDockWidget* profileDock = nullptr;
+    QLabel* profileSummary;
+    QTableWidget* profileTable;
+    ProfileData profile;
+    ServerProcess* serverProcess;
+    QDockWidget* serverDock = nullptr;
+    LogModel* serverLog;
+    QSortFilterProxyModel* serverFilter;
+    QListView* serverView;
+    QString pendingRunSource;
+    QString pendingReloadSource;
+    QString pendingReloadCommand;
+    BuildCache buildCache;
+    QTimer* watchTimer;
+    QString watchFile;
+    bool watchMode = false;
+    bool minimapVisible = true;
+    QLabel* compilerLabel;
+    SettingsStore* settingsStore;
+    AnalysisService* analysisService;
+    WorkspaceIndex* workspaceIndex;
+    QListWidget* outlineList;
+    QDockWidget* referencesDock = nullptr;
+    QListWidget* referencesList;
+    QStringList completionKeywords;
+    StallDetector* stallDetector;
+    QDockWidget* macroDock = nullptr;
+    QPlainTextEdit* macroView;
+    QLabel* macroSummary;
+    QTableWidget* macroTable;
+    QFutureWatcher<MacroExpansionReport>* macroWatcher;
+    QPointer<CodeEditor> macroEditor;
+    QLabel* buildStatusLabel;
+    QLabel* lintLabel;
     QPushButton* openFolderBtn;
     QStringList recentFiles;
     void createMenus() {
@@ -447,11 +379,49 @@ private:
         editMenu->addSeparator();
         editMenu->addAction("&Поиск...", QKeySequence::Find, this, &PawnEditor::find);
         editMenu->addAction("За&менить...", QKeySequence::Replace, this, &PawnEditor::replace);
+        editMenu->addSeparator();
+        editMenu->addAction("Перейти к &определению", QKeySequence("F12"), this, &PawnEditor::goToDefinition);
+        editMenu->addAction("Найти &ссылки", QKeySequence("Shift+F12"), this, &PawnEditor::findReferences);
+        editMenu->addAction("Переи&меновать символ...", QKeySequence("F2"), this, &PawnEditor::renameSymbol);
+        editMenu->addAction("К &парной скобке", QKeySequence("Ctrl+]"), this, &PawnEditor::jumpToMatchingBracket);
+        editMenu->addAction("К &началу функции", QKeySequence("Ctrl+Shift+Up"), this, &PawnEditor::goToEnclosingFunction);
+        editMenu->addAction("Раскрыть &макросы", QKeySequence("Ctrl+Shift+M"), this, &PawnEditor::expandMacros);
+        QAction* minimapAction = editMenu->addAction("Мини&карта");
+        minimapAction->setCheckable(true);
+        minimapAction->setChecked(minimapVisible);
+        connect(minimapAction, &QAction::toggled, this, &PawnEditor::setMinimapVisible);
         buildMenu = menuBar()->addMenu("&Сборка");
         buildMenu->addAction("&Компилировать", QKeySequence("F5"), this, &PawnEditor::compile);
+        QAction* watchAction = buildMenu->addAction("Компилировать при &сохранении");
+        watchAction->setCheckable(true);
+        watchAction->setChecked(watchMode);
+        connect(watchAction, &QAction::toggled, this, &PawnEditor::setWatchMode);
+        buildMenu->addSeparator();
+        buildMenu->addAction(QIcon(":/icons/run.png"), "&Запустить сервер", QKeySequence("F6"), this, &PawnEditor::runServer);
+        buildMenu->addAction("&Остановить сервер", QKeySequence("Shift+F6"), this, &PawnEditor::stopServer);
+        buildMenu->addAction("Пере&загрузить скрипт", QKeySequence("Ctrl+F6"), this, &PawnEditor::reloadCurrentScript);
+        buildMenu->addAction("Указать &сервер...", this, &PawnEditor::setServerPath);
+        QAction* tailAction = buildMenu->addAction("Читать server_&log.txt");
+        tailAction->setCheckable(true);
+        tailAction->setChecked(settingsStore->value("serverTailLog", false).toBool());
+        connect(tailAction, &QAction::toggled, this, [this](bool enabled) {
+            settingsStore->setValue("serverTailLog", enabled);
+        });
+        buildMenu->addSeparator();
+        buildMenu->addAction("Импорт &профиля...", this, &PawnEditor::importProfile);
+        buildMenu->addAction("&Размер AMX", this, [this]() {
+            ensureAmxDock();
+            amxDock->show();
+            amxDock->raise();
+        });
         helpMenu = menuBar()->addMenu("&Справка");
         helpMenu->addAction("&О программе", this, &PawnEditor::about);
         helpMenu->addAction("&Документация", this, &PawnEditor::openDocumentation);
+        helpMenu->addSeparator();
+        QAction* traceAction = helpMenu->addAction("&Записать трассировку");
+        traceAction->setCheckable(true);
+        connect(traceAction, &QAction::toggled, this, &PawnEditor::setTracing);
+        helpMenu->addAction("&Экспорт трассировки...", this, &PawnEditor::exportTrace);
     }
     void clearMenus() {
         menuBar()->clear();
@@ -465,6 +435,7 @@ private:
         fileToolBar->addAction(QIcon(":/icons/save.png"), "Сохранить", this, &PawnEditor::save);
         QToolBar* buildToolBar = addToolBar("Сборка");
         buildToolBar->addAction(QIcon(":/icons/compile.png"), "Компилировать", this, &PawnEditor::compile);
+        buildToolBar->addAction(QIcon(":/icons/run.png"), "Запустить сервер", this, &PawnEditor::runServer);
         QToolBar* editToolBar = addToolBar("Правка");
         editToolBar->addAction(QIcon(":/icons/undo.png"), "Отменить", this, &PawnEditor::onUndo);
         editToolBar->addAction(QIcon(":/icons/redo.png"), "Повторить", this, &PawnEditor::onRedo);
@@ -522,6 +493,17 @@ private:
             openFolderBtn->setVisible(false);
         }
         connect(fileTree, &QTreeView::doubleClicked, this, &PawnEditor::loadSelectedFile);
+        QDockWidget* outlineDock = new QDockWidget("Структура", this);
+        outlineList = new QListWidget();
+        outlineList->setStyleSheet("QListWidget { background: #252526; color: #D4D4D4; }");
+        outlineDock->setWidget(outlineList);
+        addDockWidget(Qt::LeftDockWidgetArea, outlineDock);
+        connect(outlineList, &QListWidget::itemClicked, this, [this](QListWidgetItem* item) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+            if (!editor) return;
+            editor->goToPosition(item->data(Qt::UserRole).toInt(), item->data(Qt::UserRole + 1).toInt());
+            editor->setFocus();
+        });
     }
     void setupCompleter() {
         std::vector<std::string> pawnKeywords = {
@@ -533,6 +515,7 @@ private:
         for (const auto& kw : pawnKeywords) {
             qKeywords << QString::fromStdString(kw);
         }
+        completionKeywords = qKeywords;
         completer = new QCompleter(qKeywords, this);
         completer->setCaseSensitivity(Qt::CaseInsensitive);
         completer->setWidget(editorTab->currentWidget());
@@ -542,6 +525,315 @@ private:
         QObject::connect(completer, QOverload<const QString&>::of(&QCompleter::activated),
                          this, &PawnEditor::insertCompletion);
     }
+    void registerEditor(CodeEditor* editor) {
+        editor->setMinimapVisible(minimapVisible);
+        if (!editor->filePath().isEmpty()) GitChangeTracker::forEditor(editor)->load(editor->filePath());
+        analysisService->watch(editor->document(), editor->filePath());
+    }
+    CodeEditor* editorForDocument(quintptr documentId) const {
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor && reinterpret_cast<quintptr>(editor->document()) == documentId) return editor;
+        }
+        return nullptr;
+    }
+    CodeEditor* editorForFile(const QString& filePath) const {
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor && !editor->filePath().isEmpty() && QFileInfo(editor->filePath()) == QFileInfo(filePath)) return editor;
+        }
+        return nullptr;
+    }
+    void indexAnalysis(const AnalysisResult& result) {
+        if (result.filePath.isEmpty() || !editorForDocument(result.documentId)) return;
+        workspaceIndex->updateFile(result.filePath, result.symbols, result.references);
+    }
+    void applyAnalysis(const AnalysisResult& result) {
+        CodeEditor* editor = editorForDocument(result.documentId);
+        if (!editor) return;
+        editor->syntaxHighlighter()->setIncludeMacros(result.includeMacros);
+        editor->setSemanticTable(result.semanticKinds);
+        QList<EditorDecoration> findings;
+        for (const Diagnostic& diagnostic : result.lint.diagnostics) {
+            findings.append(decorationFor(diagnostic));
+        }
+        editor->setDecorations("lint", findings);
+        if (!profile.isEmpty()) editor->setDecorations("profile", profileDecorations(result.symbols));
+        if (editor != editorTab->currentWidget()) return;
+        showLintTimings(result.lint);
+        updateOutline(result.symbols);
+        QStringList words = completionKeywords;
+        QSet<QString> seen(words.begin(), words.end());
+        for (const SymbolInfo& symbol : result.symbols) {
+            if (!seen.contains(symbol.name)) {
+                seen.insert(symbol.name);
+                words << symbol.name;
+            }
+        }
+        QStringListModel* model = qobject_cast<QStringListModel*>(completer->model());
+        if (model) {
+            words.sort(Qt::CaseInsensitive);
+            model->setStringList(words);
+        }
+    }
+    void showLintTimings(const LintReport& report) {
+        lintLabel->setText(QString("Lint: %1, %2 мс").arg(report.diagnostics.size()).arg(report.elapsedNs / 1e6, 0, 'f', 2));
+        QStringList lines;
+        for (const LintTiming& timing : report.timings) {
+            lines << QString("%1: %2 мс, замечаний %3").arg(timing.rule).arg(timing.elapsedNs / 1e6, 0, 'f', 2).arg(timing.findings);
+        }
+        lintLabel->setToolTip(lines.join('\n'));
+    }
+    static EditorDecoration decorationFor(const Diagnostic& diagnostic) {
+        EditorDecoration decoration;
+        decoration.line = diagnostic.line - 1;
+        decoration.color = diagnostic.severity == Diagnostic::Warning ? QColor("#D7BA7D")
+                           : diagnostic.severity == Diagnostic::Info ? QColor("#4FC1FF") : QColor("#F14C4C");
+        decoration.message = QString("%1 %2: %3").arg(diagnostic.source).arg(diagnostic.code).arg(diagnostic.message);
+        return decoration;
+    }
+    void updateOutline(const QList<SymbolInfo>& symbols) {
+        outlineList->clear();
+        for (const SymbolInfo& symbol : symbols) {
+            if (!symbol.isFunction() || !symbol.definition) continue;
+            QListWidgetItem* item = new QListWidgetItem(symbol.signature.isEmpty() ? symbol.name : symbol.signature);
+            item->setData(Qt::UserRole, symbol.line);
+            item->setData(Qt::UserRole + 1, symbol.column);
+            outlineList->addItem(item);
+        }
+    }
+    void openLocation(const QString& filePath, int line, int column) {
+        CodeEditor* editor = filePath.isEmpty() ? qobject_cast<CodeEditor*>(editorTab->currentWidget()) : editorForFile(filePath);
+        if (!editor && !filePath.isEmpty()) {
+            loadFile(filePath);
+            editor = editorForFile(filePath);
+        }
+        if (!editor) return;
+        editorTab->setCurrentWidget(editor);
+        editor->goToPosition(line, column);
+        editor->setFocus();
+    }
+    void goToDefinition() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (!editor) return;
+        QString name = editor->identifierAtCursor();
+        if (name.isEmpty()) return;
+        PAWNIX_TRACE("goToDefinition", "navigation");
+        QList<SymbolInfo> targets;
+        if (editor->filePath().isEmpty()) {
+            for (const SymbolInfo& symbol : analysisService->result(editor->document()).symbols) {
+                if (symbol.name == name) targets.append(symbol);
+            }
+        }
+        if (targets.isEmpty()) targets = workspaceIndex->definitions(name);
+        if (targets.isEmpty()) {
+            statusBar()->showMessage("Определение не найдено: " + name, 3000);
+            return;
+        }
+        if (targets.size() == 1) {
+            openLocation(targets.first().file, targets.first().line, targets.first().column);
+            return;
+        }
+        QMenu menu(this);
+        for (const SymbolInfo& symbol : targets) {
+            QAction* action = menu.addAction(QString("%1 %2 — %3:%4").arg(SymbolInfo::kindName(symbol.kind), symbol.name,
+                                                                          QFileInfo(symbol.file).fileName()).arg(symbol.line + 1));
+            action->setToolTip(symbol.file);
+            connect(action, &QAction::triggered, this, [this, symbol]() {
+                openLocation(symbol.file, symbol.line, symbol.column);
+            });
+        }
+        menu.exec(editor->viewport()->mapToGlobal(editor->cursorRect().bottomLeft()));
+    }
+    void ensureReferencesDock() {
+        if (referencesDock) return;
+        referencesList = new QListWidget();
+        referencesList->setStyleSheet("QListWidget { background: #252526; color: #D4D4D4; }");
+        referencesDock = new QDockWidget("Ссылки", this);
+        referencesDock->setWidget(referencesList);
+        addDockWidget(Qt::BottomDockWidgetArea, referencesDock);
+        connect(referencesList, &QListWidget::itemActivated, this, [this](QListWidgetItem* item) {
+            openLocation(item->data(Qt::UserRole).toString(), item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole + 2).toInt());
+        });
+    }
+    QStringList linesOf(const QString& filePath) const {
+        CodeEditor* editor = filePath.isEmpty() ? qobject_cast<CodeEditor*>(editorTab->currentWidget()) : editorForFile(filePath);
+        QString text;
+        if (editor) {
+            text = editor->toPlainText();
+        } else if (!SourceFile::read(filePath, text)) {
+            return QStringList();
+        }
+        return text.split('\n');
+    }
+    QList<SymbolReference> referencesTo(CodeEditor* editor, const QString& name) const {
+        QList<SymbolReference> references;
+        if (editor->filePath().isEmpty()) {
+            for (const IdentifierLocation& location : analysisService->result(editor->document()).references.value(name)) {
+                references.append(SymbolReference { QString(), location.line, location.column, int(name.size()) });
+            }
+        }
+        references.append(workspaceIndex->references(name));
+        return references;
+    }
+    void findReferences() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (!editor) return;
+        QString name = editor->identifierAtCursor();
+        if (name.isEmpty()) return;
+        PAWNIX_TRACE("findReferences", "navigation");
+        QList<SymbolReference> references = referencesTo(editor, name);
+        ensureReferencesDock();
+        referencesList->clear();
+        QHash<QString, QStringList> fileLines;
+        for (const SymbolReference& reference : references) {
+            if (referencesList->count() >= 10000) break;
+            if (!fileLines.contains(reference.file)) fileLines.insert(reference.file, linesOf(reference.file));
+            QString fileName = reference.file.isEmpty() ? QString("Новый файл") : QFileInfo(reference.file).fileName();
+            QListWidgetItem* item = new QListWidgetItem(QString("%1:%2: %3").arg(fileName).arg(reference.line + 1)
+                                                            .arg(fileLines[reference.file].value(reference.line).trimmed()));
+            item->setToolTip(reference.file);
+            item->setData(Qt::UserRole, reference.file);
+            item->setData(Qt::UserRole + 1, reference.line);
+            item->setData(Qt::UserRole + 2, reference.column);
+            referencesList->addItem(item);
+        }
+        referencesDock->setWindowTitle(QString("Ссылки: %1 (%2)").arg(name).arg(references.size()));
+        referencesDock->show();
+    }
+    void renameSymbol() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (!editor) return;
+        QString name = editor->identifierAtCursor();
+        if (name.isEmpty()) return;
+        AnalysisResult analysis = analysisService->result(editor->document());
+        QString text = editor->toPlainText();
+        const SymbolInfo* function = RenameRefactoring::enclosingFunction(analysis.symbols, editor->textCursor().blockNumber());
+        bool local = function && RenameRefactoring::declaresLocal(text, *function, name);
+        QList<SymbolReference> references;
+        if (local) {
+            for (const IdentifierLocation& location : analysis.references.value(name)) {
+                if (location.line < function->line || location.line > function->endLine) continue;
+                references.append(SymbolReference { editor->filePath(), location.line, location.column, int(name.size()) });
+            }
+        } else {
+            QList<SymbolInfo> definitions;
+            for (const SymbolInfo& symbol : workspaceIndex->symbolIndex().find(name) + analysis.symbols) {
+                if (symbol.name == name && symbol.definition) definitions.append(symbol);
+            }
+            if (definitions.isEmpty()) {
+                QMessageBox::warning(this, "Ошибка", "Не найдено определение символа " + name);
+                return;
+            }
+            for (const SymbolInfo& symbol : definitions) {
+                if (!symbol.file.isEmpty() && !isProjectFile(editor, symbol.file)) {
+                    QMessageBox::warning(this, "Ошибка", "Символ " + name + " определён вне проекта: " + symbol.file);
+                    return;
+                }
+            }
+            for (const SymbolReference& reference : referencesTo(editor, name)) {
+                if (reference.file.isEmpty() || isProjectFile(editor, reference.file)) references.append(reference);
+            }
+        }
+        bool ok;
+        QString newName = QInputDialog::getText(this, "Переименовать символ", "Новое имя для " + name + ":",
+                                                QLineEdit::Normal, name, &ok).trimmed();
+        if (!ok || newName == name) return;
+        if (!RenameRefactoring::isValidName(newName)) {
+            QMessageBox::warning(this, "Ошибка", "Недопустимое имя: " + newName);
+            return;
+        }
+        bool clash = !workspaceIndex->symbolIndex().find(newName).isEmpty()
+                     || (local && RenameRefactoring::declaresLocal(text, *function, newName));
+        for (const SymbolInfo& symbol : analysis.symbols) {
+            if (symbol.name == newName) clash = true;
+        }
+        if (clash) {
+            QMessageBox::warning(this, "Ошибка", "Имя " + newName + " уже используется");
+            return;
+        }
+        QList<RenamePlan> plans = RenameRefactoring::plan(references);
+        if (plans.isEmpty()) {
+            statusBar()->showMessage("Ссылки не найдены: " + name, 3000);
+            return;
+        }
+        RenamePreviewDialog dialog("Переименование " + name + " → " + newName, this);
+        for (const RenamePlan& plan : plans) {
+            QStringList lines = linesOf(plan.file);
+            QMap<int, QVector<IdentifierLocation>> byLine;
+            for (const IdentifierLocation& location : plan.locations) {
+                byLine[location.line].append(IdentifierLocation { 0, location.column });
+            }
+            QStringList previews;
+            for (auto it = byLine.constBegin(); it != byLine.constEnd(); ++it) {
+                previews << QString("%1: %2").arg(it.key() + 1)
+                                .arg(RenameRefactoring::apply(lines.value(it.key()), it.value(), name, newName).trimmed());
+            }
+            dialog.addFile(plan.file.isEmpty() ? QString("Новый файл") : plan.file, plan.file, plan.locations.size(), previews);
+        }
+        if (dialog.exec() != QDialog::Accepted) return;
+        PAWNIX_TRACE("renameSymbol", "refactoring");
+        QSet<QString> selected = dialog.selectedFiles();
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        QList<RenamePlan> closedFiles;
+        int replaced = 0;
+        int changedFiles = 0;
+        for (const RenamePlan& plan : plans) {
+            if (!selected.contains(plan.file)) continue;
+            CodeEditor* target = plan.file.isEmpty() ? editor : editorForFile(plan.file);
+            if (!target) {
+                closedFiles.append(plan);
+                continue;
+            }
+            int count = renameInEditor(target, plan.locations, name, newName);
+            replaced += count;
+            if (count > 0) ++changedFiles;
+        }
+        QStringList errors;
+        for (const RenameResult& result : RenameRefactoring::rewriteFiles(closedFiles, name, newName)) {
+            if (!result.error.isEmpty()) {
+                errors << QFileInfo(result.file).fileName() + ": " + result.error;
+            } else if (result.written) {
+                replaced += result.replaced;
+                ++changedFiles;
+            }
+        }
+        QApplication::restoreOverrideCursor();
+        workspaceIndex->indexWorkspace(currentFolder);
+        statusBar()->showMessage(QString("Переименовано вхождений: %1, файлов: %2").arg(replaced).arg(changedFiles), 5000);
+        if (!errors.isEmpty()) {
+            QMessageBox::warning(this, "Ошибка", "Не удалось изменить файлы:\n" + errors.join('\n'));
+        }
+    }
+    bool isProjectFile(CodeEditor* editor, const QString& filePath) const {
+        QString path = QFileInfo(filePath).absoluteFilePath();
+        if (currentFolder.isEmpty()) return !editor->filePath().isEmpty() && QFileInfo(editor->filePath()) == QFileInfo(path);
+        if (!path.startsWith(QFileInfo(currentFolder).absoluteFilePath() + '/')) return false;
+        QString source = editor->filePath().isEmpty() ? QDir(currentFolder).filePath("main.pwn") : editor->filePath();
+        for (const QString& dir : CompileRequest::forSource(QString(), source).includeDirs) {
+            if (path.startsWith(QFileInfo(dir).absoluteFilePath() + '/')) return false;
+        }
+        return true;
+    }
+    int renameInEditor(CodeEditor* editor, QVector<IdentifierLocation> locations, const QString& oldName, const QString& newName) {
+        std::sort(locations.begin(), locations.end(), [](const IdentifierLocation& a, const IdentifierLocation& b) {
+            return a.line != b.line ? a.line > b.line : a.column > b.column;
+        });
+        QTextDocument* document = editor->document();
+        QTextCursor cursor(document);
+        int count = 0;
+        cursor.beginEditBlock();
+        for (const IdentifierLocation& location : locations) {
+            QTextBlock block = document->findBlockByNumber(location.line);
+            if (!block.isValid() || !RenameRefactoring::matchesAt(block.text(), location.column, oldName)) continue;
+            cursor.setPosition(block.position() + location.column);
+            cursor.setPosition(block.position() + location.column + oldName.size(), QTextCursor::KeepAnchor);
+            cursor.insertText(newName);
+            ++count;
+        }
+        cursor.endEditBlock();
+        return count;
+    }
     void insertCompletion(const QString& completion) {
         CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
         if (currentEditor) {
@@ -551,20 +843,40 @@ private:
         }
     }
     void loadSettings() {
-        QSettings settings("kahendrik", "PawniX");
-        restoreGeometry(settings.value("geometry").toByteArray());
-        restoreState(settings.value("windowState").toByteArray());
-        pawnccPath = settings.value("compilerPath", "").toString();
-        currentFolder = settings.value("currentFolder", "").toString();
-        recentFiles = settings.value("recentFiles").toStringList();
+        restoreGeometry(settingsStore->value("geometry").toByteArray());
+        restoreState(settingsStore->value("windowState").toByteArray());
+        pawnccPath = settingsStore->value("compilerPath", "").toString();
+        currentFolder = settingsStore->value("currentFolder", "").toString();
+        recentFiles = settingsStore->value("recentFiles").toStringList();
+        watchMode = settingsStore->value("watchMode", false).toBool();
+        minimapVisible = settingsStore->value("minimap", true).toBool();
+        settingsStore->openWorkspace(currentFolder);
     }
     void saveSettings() {
-        QSettings settings("kahendrik", "PawniX");
-        settings.setValue("geometry", saveGeometry());
-        settings.setValue("windowState", saveState());
-        settings.setValue("compilerPath", pawnccPath);
-        settings.setValue("currentFolder", currentFolder);
-        settings.setValue("recentFiles", recentFiles);
+        PAWNIX_TRACE("saveSettings", "settings");
+        settingsStore->setValue("compilerPath", pawnccPath);
+        settingsStore->setValue("currentFolder", currentFolder);
+        settingsStore->setValue("recentFiles", recentFiles);
+        settingsStore->setValue("watchMode", watchMode);
+        settingsStore->setValue("minimap", minimapVisible);
+    }
+    void saveSession() {
+        QStringList openFiles;
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor && !editor->filePath().isEmpty()) {
+                openFiles << editor->filePath();
+            }
+        }
+        settingsStore->setProjectValue("openFiles", openFiles);
+    }
+    void restoreSession() {
+        const QStringList openFiles = settingsStore->projectValue("openFiles").toStringList();
+        for (const QString& file : openFiles) {
+            if (QFileInfo(file).isFile()) {
+                loadFile(file);
+            }
+        }
     }
     void findPawnCompiler(bool showDialog = true) {
         std::vector<std::string> possiblePaths = {
@@ -595,12 +907,7 @@ private:
         if (!path.isEmpty()) {
             pawnccPath = path;
             statusBar()->showMessage("Компилятор выбран: " + pawnccPath, 3000);
-            QList<QLabel*> labels = statusBar()->findChildren<QLabel*>();
-            if (!labels.isEmpty()) {
-                labels.first()->setText("Компилятор: " + pawnccPath);
-            } else {
-                statusBar()->addPermanentWidget(new QLabel("Компилятор: " + pawnccPath));
-            }
+            compilerLabel->setText("Компилятор: " + pawnccPath);
             saveSettings();
         }
     }
@@ -635,6 +942,7 @@ private:
     void newFile() {
         if (maybeSave()) {
             CodeEditor* newEditor = new CodeEditor();
+            registerEditor(newEditor);
             int index = editorTab->addTab(newEditor, "Новый файл");
             editorTab->setCurrentIndex(index);
             currentFile.clear();
@@ -691,11 +999,14 @@ private:
         }
         CodeEditor* newEditor = new CodeEditor();
         newEditor->setPlainText(content);
+        newEditor->setFilePath(fileName);
+        registerEditor(newEditor);
         int index = editorTab->addTab(newEditor, QFileInfo(fileName).fileName());
         editorTab->setCurrentIndex(index);
         currentFile = fileName;
         updateRecentFilesList(fileName);
         saveSettings();
+        saveSession();
     }
     void openFolder() {
         QString folderPath = QFileDialog::getExistingDirectory(this, "Открыть папку", "");
@@ -707,7 +1018,10 @@ private:
             openFolderBtn->setVisible(false);
             setWindowTitle("PawniX - " + QFileInfo(folderPath).fileName());
             stackedWidget->setCurrentIndex(1);
+            settingsStore->openWorkspace(currentFolder);
+            workspaceIndex->indexWorkspace(currentFolder);
             saveSettings();
+            saveSession();
         }
     }
     void compile() {
@@ -733,87 +1047,531 @@ private:
                 QMessageBox::critical(this, "Ошибка", "Не удалось сохранить файл перед компиляцией!");
                 return;
             }
+            watchTimer->stop();
         }
 
+        startBuild(currentFile, false);
+    }
+    void ensureConsole() {
         if (!errorConsole) {
             errorConsole = new QTextEdit();
             errorConsole->setReadOnly(true);
             errorConsole->setStyleSheet("background: #252526; color: #D4D4D4;");
-            QDockWidget* dock = new QDockWidget("Консоль", this);
-            dock->setWidget(errorConsole);
-            addDockWidget(Qt::BottomDockWidgetArea, dock);
+            consoleDock = new QDockWidget("Консоль", this);
+            consoleDock->setWidget(errorConsole);
+            addDockWidget(Qt::BottomDockWidgetArea, consoleDock);
+        }
+    }
+    void cancelBuild() {
+        if (compileJob) {
+            compileJob->cancel();
+            compileJob = nullptr;
+        }
+    }
+    void startBuild(const QString& sourceFile, bool background) {
+        if (pawnccPath.isEmpty() || !QFile::exists(pawnccPath) || sourceFile.isEmpty()) return;
+        cancelBuild();
+        CompileRequest request = CompileRequest::forSource(pawnccPath, sourceFile);
+        QByteArray fingerprint = buildCache.fingerprint(request);
+        if (background && buildCache.isUpToDate(request, fingerprint)) {
+            buildStatusLabel->setText("Сборка: без изменений");
+            return;
         }
+        ensureConsole();
         errorConsole->clear();
-        errorConsole->append("Начало компиляции...");
-
-        if (pawnProcess) {
-            pawnProcess->kill();
-            pawnProcess->deleteLater();
-            pawnProcess = nullptr;
+        errorConsole->append(background ? "Фоновая компиляция..." : "Начало компиляции...");
+        if (!background) {
+            consoleDock->show();
         }
+        buildStatusLabel->setText("Сборка: выполняется...");
 
-        pawnProcess = new QProcess(this);
-        QString baseDir = QFileInfo(currentFile).absolutePath();
-        pawnProcess->setWorkingDirectory(baseDir);
-
-        QStringList includeDirs;
-        if (QDir(baseDir + "/pawno/include").exists()) {
-            includeDirs << QDir::toNativeSeparators(baseDir + "/pawno/include");
+        CompileJob* job = new CompileJob(request, this);
+        compileJob = job;
+        connect(job, &CompileJob::outputReady, this, [this, job](const QString& text) {
+            if (compileJob == job) errorConsole->append(text);
+        });
+        connect(job, &CompileJob::errorReady, this, [this, job](const QString& text) {
+            if (compileJob == job) errorConsole->append(QString("<font color='white'>") + text + "</font>");
+        });
+        connect(job, &CompileJob::finished, this, [this, job, fingerprint](const CompileResult& result) {
+            job->deleteLater();
+            if (compileJob != job || result.cancelled) return;
+            compileJob = nullptr;
+            buildFinished(job->request(), fingerprint, result);
+        });
+        job->start();
+    }
+    void buildFinished(const CompileRequest& request, const QByteArray& fingerprint, const CompileResult& result) {
+        QHash<CodeEditor*, QList<EditorDecoration>> buildMarks;
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor) buildMarks.insert(editor, QList<EditorDecoration>());
         }
-        if (QDir(baseDir + "/include").exists()) {
-            includeDirs << QDir::toNativeSeparators(baseDir + "/include");
+        for (const Diagnostic& diagnostic : result.diagnostics) {
+            QString file = QFileInfo(diagnostic.file).isAbsolute() ? diagnostic.file : QDir(request.workingDir).filePath(diagnostic.file);
+            CodeEditor* editor = editorForFile(file);
+            if (editor) buildMarks[editor].append(decorationFor(diagnostic));
         }
-
-        QStringList args;
-        for (const QString& dir : includeDirs) {
-            args << "-i" << dir;
+        for (auto it = buildMarks.constBegin(); it != buildMarks.constEnd(); ++it) {
+            it.key()->setDecorations("build", it.value());
         }
-        args << QDir::toNativeSeparators(currentFile);
-        args << "-o" + QFileInfo(currentFile).baseName() + ".amx";
-
-        connect(pawnProcess, &QProcess::readyReadStandardOutput, this, &PawnEditor::readOutput);
-        connect(pawnProcess, &QProcess::readyReadStandardError, this, &PawnEditor::readError);
-        connect(pawnProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, &PawnEditor::processFinished);
-
-        pawnProcess->start(pawnccPath, args);
-        if (!pawnProcess->waitForStarted(3000)) {
+        int errors = result.count(Diagnostic::Error) + result.count(Diagnostic::Fatal);
+        int warnings = result.count(Diagnostic::Warning);
+        QString summary = QString("ошибок: %1, предупреждений: %2, %3 мс").arg(errors).arg(warnings).arg(result.elapsedMs);
+        if (!result.started) {
+            buildCache.invalidate(request);
             errorConsole->append("Ошибка: Не удалось запустить компилятор pawncc.exe");
-            errorConsole->append("Проверьте путь: " + pawnccPath);
-            pawnProcess->deleteLater();
+            errorConsole->append("Проверьте путь: " + request.compilerPath);
+            buildStatusLabel->setText("Сборка: компилятор не запущен");
+        } else if (result.success()) {
+            buildCache.store(request, fingerprint);
+            errorConsole->append(QString("<font color='green'>") + "Компилация успешно завершена!" + "</font>");
+            buildStatusLabel->setText("Сборка: успешно (" + summary + ")");
+            analyzeOutput(request);
+            if (pendingRunSource == request.sourceFile) {
+                startServer();
+            }
+            if (pendingReloadSource == request.sourceFile && serverProcess->isRunning()) {
+                serverProcess->sendCommand(pendingReloadCommand);
+                appendServerLines({ LogLine { "> " + pendingReloadCommand, LogLine::Normal, QString(), -1 } });
+            }
+        } else {
+            buildCache.invalidate(request);
+            errorConsole->append(QString("<font color='red'>") + "Ошибка компиляции! Код выхода: " + QString::number(result.exitCode) + "</font>");
+            buildStatusLabel->setText("Сборка: ошибка (" + summary + ")");
+        }
+        if (pendingRunSource == request.sourceFile) pendingRunSource.clear();
+        if (pendingReloadSource == request.sourceFile) pendingReloadSource.clear();
+    }
+    void analyzeOutput(const CompileRequest& request) {
+        PAWNIX_TRACE("analyzeOutput", "amx");
+        QString amxPath = QDir(request.workingDir).filePath(request.outputFile);
+        AmxInfo info = AmxInfo::read(amxPath);
+        if (!info.valid) {
+            errorConsole->append("AMX: не удалось разобрать " + amxPath + ": " + info.error);
             return;
         }
-
-        if (pawnProcess->state() != QProcess::Running) {
-            errorConsole->append("Ошибка: Процесс компилятора не запущен");
-            pawnProcess->deleteLater();
+        AmxInfo previous = storedAmxReport(amxPath);
+        errorConsole->append(info.summary(previous).toHtmlEscaped().replace('\n', "<br>"));
+        showAmxReport(info, previous);
+        AmxInfo carried = info;
+        carried.functionSizes = previous.functionSizes;
+        storeAmxReport(amxPath, carried);
+        if (listingJob) listingJob->cancel();
+        listingJob = nullptr;
+        listingRequest = request;
+        listingInfo = info;
+        listingPrevious = previous;
+        listingPending = true;
+        if (amxDock && amxDock->isVisible()) startListing();
+    }
+    AmxInfo storedAmxReport(const QString& amxPath) const {
+        if (amxReports.contains(amxPath)) return amxReports.value(amxPath);
+        QJsonObject reports = QJsonObject::fromVariantMap(settingsStore->projectValue("amxReports").toMap());
+        return AmxInfo::fromJson(reports.value(amxPath).toObject());
+    }
+    void storeAmxReport(const QString& amxPath, const AmxInfo& info) {
+        amxReports.insert(amxPath, info);
+        QJsonObject reports = QJsonObject::fromVariantMap(settingsStore->projectValue("amxReports").toMap());
+        reports[amxPath] = info.toJson();
+        settingsStore->setProjectValue("amxReports", reports.toVariantMap());
+    }
+    void startListing() {
+        if (!listingPending || listingJob) return;
+        listingPending = false;
+        const CompileRequest request = listingRequest;
+        const AmxInfo info = listingInfo;
+        const AmxInfo previous = listingPrevious;
+        CompileJob* job = new CompileJob(AmxListing::requestFor(request), this);
+        listingJob = job;
+        QString amxPath = QDir(request.workingDir).filePath(request.outputFile);
+        connect(job, &CompileJob::finished, this, [this, job, info, previous, amxPath](const CompileResult& result) {
+            job->deleteLater();
+            if (listingJob != job) return;
+            listingJob = nullptr;
+            QString listingPath = QDir(job->request().workingDir).filePath(job->request().outputFile);
+            if (result.cancelled || !result.success()) {
+                QFile::remove(listingPath);
+                return;
+            }
+            AmxInfo sized = info;
+            sized.functionSizes = AmxListing::read(listingPath, info.cellSize);
+            if (sized.functionSizes.isEmpty()) return;
+            showAmxReport(sized, previous);
+            storeAmxReport(amxPath, sized);
+        });
+        job->start();
+    }
+    void ensureAmxDock() {
+        if (amxDock) return;
+        amxSummary = new QLabel();
+        amxSummary->setStyleSheet("color: #D4D4D4; padding: 4px;");
+        amxTable = new QTableWidget(0, 4);
+        amxTable->setHorizontalHeaderLabels(QStringList() << "Раздел" << "Размер, Б" << "Было, Б" << "Изменение");
+        amxTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+        amxTable->verticalHeader()->setVisible(false);
+        amxTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        amxTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        amxTable->setStyleSheet("QTableWidget { background: #252526; color: #D4D4D4; }");
+        connect(amxTable, &QTableWidget::cellDoubleClicked, this, [this](int row) {
+            QTableWidgetItem* item = amxTable->item(row, 0);
+            if (!item || item->data(Qt::UserRole).toString().isEmpty()) return;
+            QList<SymbolInfo> symbols = workspaceIndex->definitions(item->data(Qt::UserRole).toString());
+            if (!symbols.isEmpty()) openLocation(symbols.first().file, symbols.first().line, symbols.first().column);
+        });
+        QWidget* container = new QWidget();
+        QVBoxLayout* layout = new QVBoxLayout(container);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->setSpacing(0);
+        layout->addWidget(amxSummary);
+        layout->addWidget(amxTable);
+        amxDock = new QDockWidget("Размер AMX", this);
+        amxDock->setWidget(container);
+        addDockWidget(Qt::RightDockWidgetArea, amxDock);
+        amxDock->hide();
+        connect(amxDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+            if (visible) startListing();
+        });
+    }
+    void showAmxReport(const AmxInfo& info, const AmxInfo& previous) {
+        ensureAmxDock();
+        amxSummary->setText(QString("Ячейка %1 Б, %2%3").arg(info.cellSize)
+                                .arg(info.isCompact() ? "сжатый, " : "")
+                                .arg(info.hasDebugInfo() ? "с отладочной информацией" : "без отладочной информации"));
+        struct Row {
+            QString section;
+            QString function;
+            qint64 size;
+            qint64 before;
+            bool known;
+        };
+        QList<Row> rows {
+            { "Код", QString(), info.codeSize, previous.codeSize, previous.valid },
+            { "Данные", QString(), info.dataSize, previous.dataSize, previous.valid },
+            { "Стек/куча", QString(), info.stackHeapSize, previous.stackHeapSize, previous.valid },
+            { "Файл", QString(), info.fileSize, previous.fileSize, previous.valid },
+        };
+        for (auto it = info.functionSizes.constBegin(); it != info.functionSizes.constEnd(); ++it) {
+            bool known = previous.functionSizes.contains(it.key());
+            rows.append(Row { "Функция " + it.key(), it.key(), it.value(), previous.functionSizes.value(it.key()), known });
+        }
+        if (!info.functionSizes.isEmpty()) {
+            for (auto it = previous.functionSizes.constBegin(); it != previous.functionSizes.constEnd(); ++it) {
+                if (!info.functionSizes.contains(it.key())) rows.append(Row { "Функция " + it.key() + " (удалена)", QString(), 0, it.value(), true });
+            }
+        }
+        amxTable->setSortingEnabled(false);
+        amxTable->setRowCount(rows.size());
+        for (int row = 0; row < rows.size(); ++row) {
+            const Row& data = rows[row];
+            QTableWidgetItem* name = new QTableWidgetItem(data.section);
+            name->setData(Qt::UserRole, data.function);
+            amxTable->setItem(row, 0, name);
+            QTableWidgetItem* size = new QTableWidgetItem();
+            size->setData(Qt::DisplayRole, data.size);
+            amxTable->setItem(row, 1, size);
+            QTableWidgetItem* before = new QTableWidgetItem();
+            if (data.known) before->setData(Qt::DisplayRole, data.before);
+            amxTable->setItem(row, 2, before);
+            QTableWidgetItem* delta = new QTableWidgetItem();
+            if (data.known) {
+                delta->setData(Qt::DisplayRole, data.size - data.before);
+                if (data.size != data.before) delta->setForeground(data.size > data.before ? QColor("#F48771") : QColor("#89D185"));
+            }
+            amxTable->setItem(row, 3, delta);
+        }
+        amxTable->setSortingEnabled(true);
+        amxTable->sortByColumn(1, Qt::DescendingOrder);
+    }
+    void importProfile() {
+        QString fileName = QFileDialog::getOpenFileName(this, "Импорт профиля", currentFolder,
+                                                        "Профиль (*.csv *.json *.txt);;Все файлы (*)");
+        if (fileName.isEmpty()) return;
+        ProfileData data = ProfileImporter::load(fileName);
+        if (!data.error.isEmpty()) {
+            QMessageBox::warning(this, "Ошибка", "Не удалось импортировать профиль: " + data.error);
             return;
         }
+        profile = data;
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (!editor || editor->filePath().isEmpty()) continue;
+            editor->setDecorations("profile", profileDecorations(workspaceIndex->symbolIndex().symbolsInFile(editor->filePath())));
+        }
+        showProfile();
+        statusBar()->showMessage(QString("Профиль загружен: %1 функций").arg(profile.entries.size()), 3000);
+    }
+    QList<EditorDecoration> profileDecorations(const QList<SymbolInfo>& symbols) const {
+        QList<EditorDecoration> marks;
+        QHash<QString, int> index = profile.byFunction();
+        double maximum = profile.maxSelf();
+        double total = profile.selfTotal();
+        for (const SymbolInfo& symbol : symbols) {
+            if (!symbol.isFunction() || !symbol.definition) continue;
+            auto it = index.constFind(symbol.name);
+            if (it == index.constEnd()) continue;
+            const ProfileEntry& entry = profile.entries[it.value()];
+            EditorDecoration decoration;
+            decoration.line = symbol.line;
+            decoration.column = symbol.column;
+            decoration.length = symbol.name.size();
+            decoration.style = EditorDecoration::Gutter;
+            decoration.color = ProfileData::heatColor(maximum > 0 ? entry.selfTime / maximum : 0);
+            decoration.message = QString("%1: вызовов %2, собственное время %3 (%4%), общее время %5")
+                                     .arg(entry.function).arg(entry.calls).arg(entry.selfTime)
+                                     .arg(total > 0 ? 100.0 * entry.selfTime / total : 0, 0, 'f', 1).arg(entry.totalTime);
+            marks.append(decoration);
+        }
+        return marks;
+    }
+    void ensureProfileDock() {
+        if (profileDock) return;
+        profileSummary = new QLabel();
+        profileSummary->setStyleSheet("color: #D4D4D4; padding: 4px;");
+        profileTable = new QTableWidget(0, 6);
+        profileTable->setHorizontalHeaderLabels(QStringList() << "Функция" << "Вызовов" << "Собств. время" << "%" << "Общее время" << "Расположение");
+        profileTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+        profileTable->verticalHeader()->setVisible(false);
+        profileTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        profileTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        profileTable->setStyleSheet("QTableWidget { background: #252526; color: #D4D4D4; }");
+        connect(profileTable, &QTableWidget::cellDoubleClicked, this, [this](int row) {
+            QTableWidgetItem* item = profileTable->item(row, 5);
+            if (!item || item->data(Qt::UserRole).toString().isEmpty()) return;
+            openLocation(item->data(Qt::UserRole).toString(), item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole + 2).toInt());
+        });
+        QWidget* container = new QWidget();
+        QVBoxLayout* layout = new QVBoxLayout(container);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->setSpacing(0);
+        layout->addWidget(profileSummary);
+        layout->addWidget(profileTable);
+        profileDock = new QDockWidget("Профиль", this);
+        profileDock->setWidget(container);
+        addDockWidget(Qt::BottomDockWidgetArea, profileDock);
+    }
+    void showProfile() {
+        ensureProfileDock();
+        double maximum = profile.maxSelf();
+        double total = profile.selfTotal();
+        int mapped = 0;
+        profileTable->setSortingEnabled(false);
+        profileTable->setRowCount(profile.entries.size());
+        for (int row = 0; row < profile.entries.size(); ++row) {
+            const ProfileEntry& entry = profile.entries[row];
+            QTableWidgetItem* name = new QTableWidgetItem(entry.type.isEmpty() ? entry.function : entry.function + " (" + entry.type + ")");
+            name->setForeground(ProfileData::heatColor(maximum > 0 ? entry.selfTime / maximum : 0));
+            profileTable->setItem(row, 0, name);
+            QTableWidgetItem* calls = new QTableWidgetItem();
+            calls->setData(Qt::DisplayRole, entry.calls);
+            profileTable->setItem(row, 1, calls);
+            QTableWidgetItem* self = new QTableWidgetItem();
+            self->setData(Qt::DisplayRole, entry.selfTime);
+            profileTable->setItem(row, 2, self);
+            QTableWidgetItem* share = new QTableWidgetItem();
+            share->setData(Qt::DisplayRole, total > 0 ? qRound(1000.0 * entry.selfTime / total) / 10.0 : 0.0);
+            profileTable->setItem(row, 3, share);
+            QTableWidgetItem* totalTime = new QTableWidgetItem();
+            totalTime->setData(Qt::DisplayRole, entry.totalTime);
+            profileTable->setItem(row, 4, totalTime);
+            QList<SymbolInfo> definitions = workspaceIndex->definitions(entry.function);
+            QTableWidgetItem* location = new QTableWidgetItem();
+            if (!definitions.isEmpty()) {
+                const SymbolInfo& symbol = definitions.first();
+                location->setText(QString("%1:%2").arg(QFileInfo(symbol.file).fileName()).arg(symbol.line + 1));
+                location->setData(Qt::UserRole, symbol.file);
+                location->setData(Qt::UserRole + 1, symbol.line);
+                location->setData(Qt::UserRole + 2, symbol.column);
+                ++mapped;
+            }
+            profileTable->setItem(row, 5, location);
+        }
+        profileTable->setSortingEnabled(true);
+        profileTable->sortByColumn(2, Qt::DescendingOrder);
+        profileSummary->setText(QString("%1: функций %2, найдено в исходниках %3")
+                                    .arg(QFileInfo(profile.file).fileName()).arg(profile.entries.size()).arg(mapped));
+        profileDock->show();
+        profileDock->raise();
+    }
+    QString serverExecutable() const {
+        QString configured = settingsStore->projectValue("serverPath", settingsStore->value("serverPath")).toString();
+        if (!configured.isEmpty() && QFileInfo(configured).isFile()) return configured;
+        if (currentFolder.isEmpty()) return QString();
+        for (const QString& name : { "omp-server.exe", "samp-server.exe", "omp-server", "samp03svr" }) {
+            QString candidate = QDir(currentFolder).filePath(name);
+            if (QFileInfo(candidate).isFile()) return candidate;
+        }
+        return QString();
     }
-    void readOutput() {
-        if (errorConsole && pawnProcess) {
-            QByteArray data = pawnProcess->readAllStandardOutput();
-            errorConsole->append(QString::fromLocal8Bit(data));
+    void setServerPath() {
+        QString path = QFileDialog::getOpenFileName(this, "Указать исполняемый файл сервера", currentFolder,
+                                                    "Сервер (*.exe samp03svr omp-server);;Все файлы (*)");
+        if (path.isEmpty()) return;
+        if (settingsStore->projectPath().isEmpty()) {
+            settingsStore->setValue("serverPath", path);
+        } else {
+            settingsStore->setProjectValue("serverPath", path);
+        }
+        statusBar()->showMessage("Сервер выбран: " + path, 3000);
+    }
+    void runServer() {
+        if (serverExecutable().isEmpty()) {
+            setServerPath();
+            if (serverExecutable().isEmpty()) return;
+        }
+        pendingRunSource = currentFile;
+        compile();
+        if (!compileJob) pendingRunSource.clear();
+    }
+    void startServer() {
+        QString executable = serverExecutable();
+        if (executable.isEmpty()) return;
+        ensureServerDock();
+        serverDock->show();
+        serverDock->raise();
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor) editor->setDecorations("runtime", QList<EditorDecoration>());
         }
+        QString logFile = settingsStore->value("serverTailLog", false).toBool()
+                              ? QDir(QFileInfo(executable).absolutePath()).filePath("server_log.txt") : QString();
+        appendServerLines({ LogLine { (serverProcess->isRunning() ? "Перезапуск " : "Запуск ") + executable, LogLine::Normal, QString(), -1 } });
+        serverProcess->start(executable, logFile);
+        statusBar()->showMessage("Сервер запущен: " + executable, 3000);
+    }
+    void stopServer() {
+        if (!serverProcess->isRunning()) return;
+        serverProcess->stop();
+        statusBar()->showMessage("Остановка сервера...", 3000);
+    }
+    void reloadCurrentScript() {
+        if (!serverProcess->isRunning()) {
+            statusBar()->showMessage("Сервер не запущен", 3000);
+            return;
+        }
+        QFileInfo info(currentFile);
+        QString folder = info.absoluteDir().dirName().toLower();
+        if (folder == "filterscripts") {
+            pendingReloadCommand = "reloadfs " + info.completeBaseName();
+        } else if (folder == "gamemodes") {
+            pendingReloadCommand = "gmx";
+        } else {
+            statusBar()->showMessage("Скрипт должен находиться в gamemodes или filterscripts", 3000);
+            return;
+        }
+        pendingReloadSource = currentFile;
+        compile();
+        if (!compileJob) pendingReloadSource.clear();
+    }
+    void ensureServerDock() {
+        if (serverDock) return;
+        serverLog = new LogModel(20000, this);
+        serverFilter = new QSortFilterProxyModel(this);
+        serverFilter->setSourceModel(serverLog);
+        serverFilter->setFilterCaseSensitivity(Qt::CaseInsensitive);
+        serverView = new QListView();
+        serverView->setModel(serverFilter);
+        serverView->setUniformItemSizes(true);
+        serverView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        serverView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        serverView->setFont(QFont("Consolas", 10));
+        serverView->setStyleSheet("QListView { background: #252526; color: #D4D4D4; }");
+        connect(serverView, &QListView::doubleClicked, this, [this](const QModelIndex& index) {
+            QString file = resolveServerFile(index.data(Qt::UserRole).toString());
+            int line = index.data(Qt::UserRole + 1).toInt();
+            if (!file.isEmpty() && line > 0) openLocation(file, line - 1, 0);
+        });
+        QLineEdit* filterEdit = new QLineEdit();
+        filterEdit->setPlaceholderText("Фильтр");
+        connect(filterEdit, &QLineEdit::textChanged, serverFilter, &QSortFilterProxyModel::setFilterFixedString);
+        QLineEdit* commandEdit = new QLineEdit();
+        commandEdit->setPlaceholderText("Команда сервера (например, reloadfs admin)");
+        connect(commandEdit, &QLineEdit::returnPressed, this, [this, commandEdit]() {
+            QString command = commandEdit->text().trimmed();
+            if (command.isEmpty() || !serverProcess->isRunning()) return;
+            serverProcess->sendCommand(command);
+            appendServerLines({ LogLine { "> " + command, LogLine::Normal, QString(), -1 } });
+            commandEdit->clear();
+        });
+        QPushButton* clearButton = new QPushButton("Очистить");
+        connect(clearButton, &QPushButton::clicked, serverLog, &LogModel::clear);
+        QWidget* bar = new QWidget();
+        QHBoxLayout* barLayout = new QHBoxLayout(bar);
+        barLayout->setContentsMargins(0, 0, 0, 0);
+        barLayout->addWidget(filterEdit);
+        barLayout->addWidget(clearButton);
+        QWidget* container = new QWidget();
+        QVBoxLayout* layout = new QVBoxLayout(container);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->setSpacing(0);
+        layout->addWidget(bar);
+        layout->addWidget(serverView);
+        layout->addWidget(commandEdit);
+        serverDock = new QDockWidget("Сервер", this);
+        serverDock->setWidget(container);
+        addDockWidget(Qt::BottomDockWidgetArea, serverDock);
     }
-    void readError() {
-        if (errorConsole && pawnProcess) {
-            QByteArray data = pawnProcess->readAllStandardError();
-            errorConsole->append(QString("<font color='white'>") + QString::fromLocal8Bit(data) + "</font>");
+    QString resolveServerFile(const QString& file) const {
+        if (file.isEmpty()) return QString();
+        QFileInfo info(file);
+        if (info.isAbsolute()) return info.isFile() ? info.absoluteFilePath() : QString();
+        QString serverDir = QFileInfo(serverExecutable()).absolutePath();
+        for (const QString& base : { serverDir, serverDir + "/gamemodes", serverDir + "/filterscripts", currentFolder }) {
+            QFileInfo candidate(QDir(base).filePath(file));
+            if (!base.isEmpty() && candidate.isFile()) return candidate.absoluteFilePath();
         }
+        return QString();
     }
-    void processFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-        if (errorConsole) {
-            if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-                errorConsole->append(QString("<font color='green'>") + "Компилация успешно завершена!" + "</font>");
+    void appendServerLines(const QList<LogLine>& lines) {
+        ensureServerDock();
+        QScrollBar* scrollBar = serverView->verticalScrollBar();
+        bool atBottom = scrollBar->value() == scrollBar->maximum();
+        serverLog->append(lines);
+        if (atBottom) serverView->scrollToBottom();
+        QHash<CodeEditor*, QList<EditorDecoration>> runtimeMarks;
+        for (const LogLine& line : lines) {
+            if (line.kind != LogLine::Error || line.line <= 0) continue;
+            CodeEditor* editor = editorForFile(resolveServerFile(line.file));
+            if (!editor) continue;
+            if (!runtimeMarks.contains(editor)) runtimeMarks.insert(editor, editor->decorations("runtime"));
+            EditorDecoration decoration;
+            decoration.line = line.line - 1;
+            decoration.color = QColor("#F14C4C");
+            decoration.message = "Сервер: " + line.text;
+            QList<EditorDecoration>& marks = runtimeMarks[editor];
+            auto existing = std::find_if(marks.begin(), marks.end(), [&decoration](const EditorDecoration& mark) {
+                return mark.line == decoration.line;
+            });
+            if (existing != marks.end()) {
+                *existing = decoration;
             } else {
-                errorConsole->append(QString("<font color='red'>") + "Ошибка компиляции! Код выхода: " + QString::number(exitCode) + "</font>");
+                marks.append(decoration);
             }
         }
-        if (pawnProcess) {
-            pawnProcess->deleteLater();
-            pawnProcess = nullptr;
+        for (auto it = runtimeMarks.constBegin(); it != runtimeMarks.constEnd(); ++it) {
+            it.key()->setDecorations("runtime", it.value());
+        }
+    }
+    void setMinimapVisible(bool visible) {
+        minimapVisible = visible;
+        for (int i = 0; i < editorTab->count(); ++i) {
+            CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->widget(i));
+            if (editor) editor->setMinimapVisible(visible);
+        }
+        saveSettings();
+    }
+    void setWatchMode(bool enabled) {
+        watchMode = enabled;
+        if (!enabled) {
+            watchTimer->stop();
         }
+        saveSettings();
+    }
+    void scheduleWatchBuild(const QString& fileName) {
+        if (!watchMode) return;
+        watchFile = fileName;
+        cancelBuild();
+        watchTimer->start();
     }
     void about() {
         QString aboutText =
@@ -831,6 +1589,34 @@ private:
     void openDocumentation() {
         QDesktopServices::openUrl(QUrl("https://pawnix.gitbook.io/"));
     }
+    void setTracing(bool enabled) {
+        if (enabled) {
+            Tracer::instance().start();
+            statusBar()->showMessage("Запись трассировки...");
+        } else {
+            Tracer::instance().stop();
+            statusBar()->showMessage("Трассировка остановлена, событий: " + QString::number(Tracer::instance().eventCount()), 3000);
+        }
+        stallDetector->setActive(enabled);
+    }
+    void exportTrace() {
+        QString fileName = QFileDialog::getSaveFileName(this,
+                                                        "Экспорт трассировки",
+                                                        "pawnix-trace.json",
+                                                        "Chrome Trace (*.json)");
+        if (fileName.isEmpty()) return;
+        QSaveFile file(fileName);
+        if (!file.open(QFile::WriteOnly)) {
+            QMessageBox::warning(this, "Ошибка", "Не могу сохранить файл: " + file.errorString());
+            return;
+        }
+        file.write(Tracer::instance().toChromeJson());
+        if (!file.commit()) {
+            QMessageBox::warning(this, "Ошибка", "Не могу сохранить файл: " + file.errorString());
+            return;
+        }
+        statusBar()->showMessage("Трассировка сохранена: " + fileName, 3000);
+    }
     void find() {
         CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
         if (currentEditor) {
@@ -847,6 +1633,14 @@ private:
             dialog.exec();
         }
     }
+    void jumpToMatchingBracket() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (editor) editor->jumpToMatchingBracket();
+    }
+    void goToEnclosingFunction() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (editor) editor->goToEnclosingFunction();
+    }
     void goToLine() {
         CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
         if (currentEditor) {
@@ -858,6 +1652,127 @@ private:
             }
         }
     }
+    void ensureMacroDock() {
+        if (macroDock) return;
+        macroView = new QPlainTextEdit();
+        macroView->setReadOnly(true);
+        macroView->setLineWrapMode(QPlainTextEdit::NoWrap);
+        macroView->setFont(QFont("Consolas", 10));
+        macroView->setStyleSheet("background: #1E1E1E; color: #D4D4D4;");
+        new PawnHighlighter(macroView->document());
+        macroSummary = new QLabel();
+        macroSummary->setStyleSheet("color: #D4D4D4; padding: 4px;");
+        macroTable = new QTableWidget(0, 4);
+        macroTable->setHorizontalHeaderLabels(QStringList() << "Функция" << "Токенов" << "После раскрытия" << "Рост");
+        macroTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+        macroTable->verticalHeader()->setVisible(false);
+        macroTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        macroTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        macroTable->setStyleSheet("QTableWidget { background: #252526; color: #D4D4D4; }");
+        connect(macroTable, &QTableWidget::cellDoubleClicked, this, [this](int row) {
+            QTableWidgetItem* item = macroTable->item(row, 0);
+            if (!item || !macroEditor) return;
+            editorTab->setCurrentWidget(macroEditor);
+            macroEditor->goToLine(item->data(Qt::UserRole).toInt() + 1);
+        });
+        QWidget* container = new QWidget();
+        QVBoxLayout* layout = new QVBoxLayout(container);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->setSpacing(0);
+        QSplitter* splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(macroView);
+        splitter->addWidget(macroTable);
+        layout->addWidget(macroSummary);
+        layout->addWidget(splitter);
+        macroDock = new QDockWidget("Раскрытие макросов", this);
+        macroDock->setWidget(container);
+        addDockWidget(Qt::RightDockWidgetArea, macroDock);
+    }
+    static QString blockText(QTextDocument* document, int firstLine, int lastLine) {
+        QStringList lines;
+        for (QTextBlock block = document->findBlockByNumber(firstLine);
+             block.isValid() && block.blockNumber() <= lastLine; block = block.next()) {
+            lines << block.text();
+        }
+        return lines.join('\n');
+    }
+    void expandMacros() {
+        CodeEditor* editor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
+        if (!editor) return;
+        PAWNIX_TRACE("expandMacros", "preprocessor");
+        QTextDocument* document = editor->document();
+        QTextCursor cursor = editor->textCursor();
+        QList<SymbolInfo> symbols = analysisService->result(document).symbols;
+        QString selection;
+        int firstLine = cursor.blockNumber();
+        if (cursor.hasSelection()) {
+            firstLine = document->findBlock(cursor.selectionStart()).blockNumber();
+            selection = cursor.selectedText().replace(QChar::ParagraphSeparator, '\n');
+        } else {
+            for (const SymbolInfo& symbol : symbols) {
+                if (symbol.isFunction() && symbol.line <= firstLine && firstLine <= symbol.endLine) {
+                    firstLine = symbol.line;
+                    selection = blockText(document, symbol.line, symbol.endLine);
+                    break;
+                }
+            }
+            if (selection.isNull()) selection = cursor.block().text();
+        }
+        QList<QPair<SymbolInfo, QString>> functions;
+        for (const SymbolInfo& symbol : symbols) {
+            if (symbol.isFunction() && symbol.endLine > symbol.line) {
+                functions.append(qMakePair(symbol, blockText(document, symbol.line, symbol.endLine)));
+            }
+        }
+        MacroTable selectionMacros = editor->syntaxHighlighter()->macrosBefore(firstLine);
+        MacroTable fileMacros = editor->syntaxHighlighter()->macrosBefore(document->blockCount());
+        macroEditor = editor;
+        ensureMacroDock();
+        macroDock->show();
+        macroSummary->setText("Раскрытие макросов...");
+        macroWatcher->setFuture(QtConcurrent::run([selection, firstLine, functions, selectionMacros, fileMacros]() {
+            MacroExpansionReport report;
+            report.firstLine = firstLine;
+            report.expanded = MacroExpander(selectionMacros).expand(selection, &report.substitutions);
+            report.tokensBefore = MacroExpander::countTokens(selection);
+            report.tokensAfter = MacroExpander::countTokens(report.expanded);
+            MacroExpander expander(fileMacros);
+            for (const auto& function : functions) {
+                MacroExpansionReport::Function stats;
+                stats.name = function.first.name;
+                stats.line = function.first.line;
+                stats.tokensBefore = MacroExpander::countTokens(function.second);
+                stats.tokensAfter = MacroExpander::countTokens(expander.expand(function.second));
+                report.functions.append(stats);
+            }
+            return report;
+        }));
+    }
+    void showMacroExpansion(const MacroExpansionReport& report) {
+        macroView->setPlainText(report.expanded);
+        macroSummary->setText(QString("Строка %1: подстановок %2, токенов %3 → %4")
+                                  .arg(report.firstLine + 1).arg(report.substitutions)
+                                  .arg(report.tokensBefore).arg(report.tokensAfter));
+        macroTable->setSortingEnabled(false);
+        macroTable->setRowCount(report.functions.size());
+        for (int row = 0; row < report.functions.size(); ++row) {
+            const MacroExpansionReport::Function& function = report.functions[row];
+            QTableWidgetItem* name = new QTableWidgetItem(function.name);
+            name->setData(Qt::UserRole, function.line);
+            macroTable->setItem(row, 0, name);
+            QTableWidgetItem* before = new QTableWidgetItem();
+            before->setData(Qt::DisplayRole, function.tokensBefore);
+            macroTable->setItem(row, 1, before);
+            QTableWidgetItem* after = new QTableWidgetItem();
+            after->setData(Qt::DisplayRole, function.tokensAfter);
+            macroTable->setItem(row, 2, after);
+            QTableWidgetItem* ratio = new QTableWidgetItem();
+            ratio->setData(Qt::DisplayRole, qRound(10.0 * function.tokensAfter / qMax(1, function.tokensBefore)) / 10.0);
+            macroTable->setItem(row, 3, ratio);
+        }
+        macroTable->setSortingEnabled(true);
+        macroTable->sortByColumn(2, Qt::DescendingOrder);
+    }
     bool maybeSave() {
         CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
         if (!currentEditor || !currentEditor->document()->isModified()) return true;
@@ -870,6 +1785,7 @@ private:
         return true;
     }
     void loadFile(const QString& fileName) {
+        PAWNIX_TRACE("loadFile", "io");
         QFile file(fileName);
         if (!file.open(QFile::ReadOnly)) {
             QMessageBox::warning(this, "Ошибка", "Не могу открыть файл: " + file.errorString());
@@ -877,19 +1793,21 @@ private:
         }
         QByteArray data = file.readAll();
         file.close();
-        QTextCodec* codec = QTextCodec::codecForName("Windows-1251");
-        if (!codec) {
+        if (!SourceFile::codec()) {
             QMessageBox::critical(this, "Ошибка", "Кодировка Windows-1251 не поддерживается!");
             return;
         }
-        QString content = codec->toUnicode(data);
+        QString content = SourceFile::decode(data);
         CodeEditor* newEditor = new CodeEditor();
         newEditor->setPlainText(content);
+        newEditor->setFilePath(fileName);
+        registerEditor(newEditor);
         int index = editorTab->addTab(newEditor, QFileInfo(fileName).fileName());
         editorTab->setCurrentIndex(index);
         currentFile = fileName;
         updateRecentFilesList(fileName);
         saveSettings();
+        saveSession();
     }
     bool save() {
         CodeEditor* currentEditor = qobject_cast<CodeEditor*>(editorTab->currentWidget());
@@ -910,13 +1828,13 @@ private:
         return saveFile(fileName);
     }
     bool saveFile(const QString& fileName) {
+        PAWNIX_TRACE("saveFile", "io");
         QFile file(fileName);
         if (!file.open(QFile::WriteOnly | QFile::Text)) {
             QMessageBox::warning(this, "Ошибка", "Не могу сохранить файл: " + file.errorString());
             return false;
         }
-        QTextCodec* codec = QTextCodec::codecForName("Windows-1251");
-        if (!codec) {
+        if (!SourceFile::codec()) {
             QMessageBox::critical(this, "Ошибка", "Кодировка Windows-1251 не поддерживается!");
             return false;
         }
@@ -925,13 +1843,22 @@ private:
             QMessageBox::critical(this, "Ошибка", "Нет активного редактора!");
             return false;
         }
-        QByteArray encodedData = codec->fromUnicode(currentEditor->toPlainText());
+        QByteArray encodedData = SourceFile::encode(currentEditor->toPlainText());
         file.write(encodedData);
         file.close();
+        bool renamed = currentEditor->filePath() != fileName;
+        if (!currentEditor->filePath().isEmpty() && renamed) {
+            workspaceIndex->releaseFile(currentEditor->filePath());
+        }
         currentFile = fileName;
+        currentEditor->setFilePath(fileName);
+        if (renamed) GitChangeTracker::forEditor(currentEditor)->load(fileName);
+        analysisService->setFilePath(currentEditor->document(), fileName);
         setWindowTitle("PawniX - " + QFileInfo(fileName).fileName());
         currentEditor->document()->setModified(false);
         updateRecentFilesList(fileName);
+        saveSession();
+        scheduleWatchBuild(fileName);
         return true;
     }
     void updateRecentFilesList(const QString &filePath) {
@@ -990,8 +1917,13 @@ private:
     void closeTab(int index) {
         if (maybeSave()) {
             QWidget* widget = editorTab->widget(index);
+            CodeEditor* editor = qobject_cast<CodeEditor*>(widget);
+            if (editor && !editor->filePath().isEmpty()) {
+                workspaceIndex->releaseFile(editor->filePath());
+            }
             editorTab->removeTab(index);
             delete widget;
+            saveSession();
         }
     }
     void updateTabTitle() {
@@ -1013,6 +1945,10 @@ private:
     QMenu* helpMenu;
 };
 int main(int argc, char* argv[]) {
+    if (HeadlessRunner::isHeadless(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return HeadlessRunner(app.arguments()).run();
+    }
     QApplication app(argc, argv);
     QPalette darkPalette;
     darkPalette.setColor(QPalette::Base, QColor("#1E1E1E"));
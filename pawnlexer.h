@@ -0,0 +1,118 @@
+#ifndef PAWNLEXER_H
+#define PAWNLEXER_H
+
+#include "includes.h"
+
+struct PawnToken {
+    enum Kind { Identifier, Number, String, Character, Comment, Directive, Operator };
+    Kind kind;
+    int start;
+    int length;
+    int line;
+    int column;
+};
+
+class PawnLexer {
+public:
+    static QVector<PawnToken> tokenize(const QString& text, bool keepComments = false) {
+        QVector<PawnToken> tokens;
+        tokens.reserve(text.size() / 4);
+        const QChar* data = text.constData();
+        const int size = text.size();
+        int pos = 0;
+        int line = 0;
+        int lineStart = 0;
+        bool atLineStart = true;
+        auto push = [&](PawnToken::Kind kind, int start, int end) {
+            tokens.append(PawnToken { kind, start, end - start, line, start - lineStart });
+        };
+        while (pos < size) {
+            QChar c = data[pos];
+            if (c == '\n') {
+                ++pos;
+                ++line;
+                lineStart = pos;
+                atLineStart = true;
+                continue;
+            }
+            if (c.isSpace()) {
+                ++pos;
+                continue;
+            }
+            int start = pos;
+            if (c == '/' && pos + 1 < size && data[pos + 1] == '/') {
+                while (pos < size && data[pos] != '\n') ++pos;
+                if (keepComments) push(PawnToken::Comment, start, pos);
+                continue;
+            }
+            if (c == '/' && pos + 1 < size && data[pos + 1] == '*') {
+                int startLine = line;
+                int startColumn = start - lineStart;
+                pos += 2;
+                while (pos < size && !(data[pos] == '*' && pos + 1 < size && data[pos + 1] == '/')) {
+                    if (data[pos] == '\n') {
+                        ++line;
+                        lineStart = pos + 1;
+                    }
+                    ++pos;
+                }
+                pos = qMin(size, pos + 2);
+                if (keepComments) {
+                    tokens.append(PawnToken { PawnToken::Comment, start, pos - start, startLine, startColumn });
+                }
+                continue;
+            }
+            if (c == '#' && atLineStart) {
+                ++pos;
+                while (pos < size && (data[pos] == ' ' || data[pos] == '\t')) ++pos;
+                while (pos < size && isIdentifierChar(data[pos])) ++pos;
+                push(PawnToken::Directive, start, pos);
+                atLineStart = false;
+                continue;
+            }
+            atLineStart = false;
+            if (c == '"' || ((c == '!' || c == '\\') && pos + 1 < size && data[pos + 1] == '"')) {
+                bool raw = c == '\\';
+                pos = c == '"' ? pos + 1 : pos + 2;
+                while (pos < size && data[pos] != '"' && data[pos] != '\n') {
+                    if (!raw && data[pos] == '\\' && pos + 1 < size && data[pos + 1] != '\n') ++pos;
+                    ++pos;
+                }
+                if (pos < size && data[pos] == '"') ++pos;
+                push(PawnToken::String, start, pos);
+                continue;
+            }
+            if (c == '\'') {
+                ++pos;
+                while (pos < size && data[pos] != '\'' && data[pos] != '\n') {
+                    if (data[pos] == '\\' && pos + 1 < size && data[pos + 1] != '\n') ++pos;
+                    ++pos;
+                }
+                if (pos < size && data[pos] == '\'') ++pos;
+                push(PawnToken::Character, start, pos);
+                continue;
+            }
+            if (c.isDigit()) {
+                while (pos < size && (data[pos].isLetterOrNumber() || data[pos] == '_' || data[pos] == '.')) ++pos;
+                push(PawnToken::Number, start, pos);
+                continue;
+            }
+            if (isIdentifierStart(c)) {
+                while (pos < size && isIdentifierChar(data[pos])) ++pos;
+                push(PawnToken::Identifier, start, pos);
+                continue;
+            }
+            ++pos;
+            push(PawnToken::Operator, start, pos);
+        }
+        return tokens;
+    }
+    static bool isIdentifierStart(QChar c) {
+        return c.isLetter() || c == '_' || c == '@';
+    }
+    static bool isIdentifierChar(QChar c) {
+        return c.isLetterOrNumber() || c == '_' || c == '@';
+    }
+};
+
+#endif
@@ -0,0 +1,604 @@
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include "includes.h"
+#include "pawnlexer.h"
+
+struct MacroDefinition {
+    QString name;
+    QString pattern;
+    QString replacement;
+    int line = -1;
+    bool operator==(const MacroDefinition& other) const {
+        return name == other.name && pattern == other.pattern && replacement == other.replacement;
+    }
+    static bool parse(QStringView body, MacroDefinition& macro) {
+        int pos = 0;
+        while (pos < body.size() && body[pos].isSpace()) ++pos;
+        int nameStart = pos;
+        while (pos < body.size() && PawnLexer::isIdentifierChar(body[pos])) ++pos;
+        if (pos == nameStart) return false;
+        macro.name = body.mid(nameStart, pos - nameStart).toString();
+        int patternStart = pos;
+        while (pos < body.size() && !body[pos].isSpace()) ++pos;
+        macro.pattern = body.mid(patternStart, pos - patternStart).toString();
+        QString replacement = body.mid(pos).toString();
+        int comment = replacement.indexOf("//");
+        if (comment >= 0) replacement.truncate(comment);
+        if (replacement.endsWith('\\')) replacement.chop(1);
+        macro.replacement = replacement.trimmed();
+        return true;
+    }
+};
+
+using MacroTable = QHash<QString, MacroDefinition>;
+using MacroLookup = std::function<const MacroDefinition*(const QString&)>;
+
+class ExpressionEvaluator {
+public:
+    static qint64 evaluate(const QString& expression, const MacroTable& macros, int depth = 0) {
+        return evaluate(expression, [&macros](const QString& name) {
+            auto it = macros.constFind(name);
+            return it == macros.constEnd() ? nullptr : &it.value();
+        }, depth);
+    }
+    static qint64 evaluate(const QString& expression, const MacroLookup& lookup, int depth = 0) {
+        ExpressionEvaluator evaluator(expression, lookup, depth);
+        return evaluator.parseConditional();
+    }
+private:
+    ExpressionEvaluator(const QString& expression, const MacroLookup& macroLookup, int nesting)
+        : text(expression), lookup(macroLookup), depth(nesting) {}
+    QString text;
+    const MacroLookup& lookup;
+    int depth;
+    int pos = 0;
+
+    void skipSpace() {
+        while (pos < text.size() && text[pos].isSpace()) ++pos;
+    }
+    bool accept(const char* op) {
+        skipSpace();
+        int length = int(qstrlen(op));
+        if (QStringView(text).mid(pos, length) != QLatin1String(op, length)) return false;
+        if (length == 1 && pos + 1 < text.size()) {
+            QChar next = text[pos + 1];
+            if ((op[0] == '&' || op[0] == '|' || op[0] == '<' || op[0] == '>') && next == op[0]) return false;
+            if ((op[0] == '<' || op[0] == '>' || op[0] == '!' || op[0] == '=') && next == '=') return false;
+        }
+        pos += length;
+        return true;
+    }
+    QString identifier() {
+        skipSpace();
+        int start = pos;
+        while (pos < text.size() && PawnLexer::isIdentifierChar(text[pos])) ++pos;
+        return text.mid(start, pos - start);
+    }
+    qint64 parseConditional() {
+        qint64 condition = parseBinary(0);
+        if (accept("?")) {
+            qint64 whenTrue = parseConditional();
+            accept(":");
+            qint64 whenFalse = parseConditional();
+            return condition ? whenTrue : whenFalse;
+        }
+        return condition;
+    }
+    qint64 parseBinary(int level) {
+        static const QList<QStringList> levels {
+            { "||" }, { "&&" }, { "|" }, { "^" }, { "&" }, { "==", "!=" },
+            { "<=", ">=", "<", ">" }, { "<<", ">>" }, { "+", "-" }, { "*", "/", "%" }
+        };
+        if (level >= levels.size()) return parseUnary();
+        qint64 left = parseBinary(level + 1);
+        while (true) {
+            QString matched;
+            for (const QString& op : levels[level]) {
+                if (accept(op.toLatin1().constData())) {
+                    matched = op;
+                    break;
+                }
+            }
+            if (matched.isEmpty()) return left;
+            qint64 right = parseBinary(level + 1);
+            if (matched == "||") left = left || right;
+            else if (matched == "&&") left = left && right;
+            else if (matched == "|") left |= right;
+            else if (matched == "^") left ^= right;
+            else if (matched == "&") left &= right;
+            else if (matched == "==") left = left == right;
+            else if (matched == "!=") left = left != right;
+            else if (matched == "<=") left = left <= right;
+            else if (matched == ">=") left = left >= right;
+            else if (matched == "<") left = left < right;
+            else if (matched == ">") left = left > right;
+            else if (matched == "<<") left <<= (right & 63);
+            else if (matched == ">>") left >>= (right & 63);
+            else if (matched == "+") left += right;
+            else if (matched == "-") left -= right;
+            else if (matched == "*") left *= right;
+            else if (matched == "/") left = right ? left / right : 0;
+            else if (matched == "%") left = right ? left % right : 0;
+        }
+    }
+    qint64 parseUnary() {
+        if (accept("!")) return !parseUnary();
+        if (accept("~")) return ~parseUnary();
+        if (accept("-")) return -parseUnary();
+        if (accept("+")) return parseUnary();
+        return parsePrimary();
+    }
+    qint64 parsePrimary() {
+        skipSpace();
+        if (pos >= text.size()) return 0;
+        if (accept("(")) {
+            qint64 value = parseConditional();
+            accept(")");
+            return value;
+        }
+        QChar c = text[pos];
+        if (c.isDigit()) {
+            int start = pos;
+            while (pos < text.size() && (text[pos].isLetterOrNumber() || text[pos] == '_')) ++pos;
+            QString number = text.mid(start, pos - start).remove('_');
+            bool ok = false;
+            qint64 value = 0;
+            if (number.startsWith("0x", Qt::CaseInsensitive)) value = number.mid(2).toLongLong(&ok, 16);
+            else if (number.startsWith("0b", Qt::CaseInsensitive)) value = number.mid(2).toLongLong(&ok, 2);
+            else value = number.toLongLong(&ok, 10);
+            return ok ? value : 0;
+        }
+        if (c == '\'') {
+            ++pos;
+            qint64 value = pos < text.size() ? text[pos].unicode() : 0;
+            while (pos < text.size() && text[pos] != '\'') ++pos;
+            ++pos;
+            return value;
+        }
+        QString name = identifier();
+        if (name.isEmpty()) {
+            ++pos;
+            return 0;
+        }
+        if (name == "defined") {
+            bool parenthesized = accept("(");
+            QString macro = identifier();
+            if (parenthesized) accept(")");
+            return lookup(macro) ? 1 : 0;
+        }
+        if (name == "true") return 1;
+        if (name == "false") return 0;
+        const MacroDefinition* macro = lookup(name);
+        if (!macro || !macro->pattern.isEmpty() || depth > 16) return 0;
+        return evaluate(macro->replacement, lookup, depth + 1);
+    }
+};
+
+struct PreprocessorState {
+    enum Frame : quint8 { Active = 1, Taken = 2, ParentActive = 4 };
+    QVector<quint8> frames;
+    QString pendingDefine;
+    bool continuation = false;
+    bool ended = false;
+    bool isActive() const {
+        return !ended && (frames.isEmpty() || (frames.last() & Active));
+    }
+    bool operator==(const PreprocessorState& other) const {
+        return frames == other.frames && continuation == other.continuation && ended == other.ended
+               && pendingDefine == other.pendingDefine;
+    }
+};
+
+struct MacroEvent {
+    MacroDefinition macro;
+    bool undefined = false;
+    bool operator==(const MacroEvent& other) const {
+        return macro == other.macro && undefined == other.undefined;
+    }
+};
+
+struct LineEffect {
+    MacroEvent event;
+    QString include;
+    bool condition = false;
+    QStringList dependencies;
+};
+
+class MacroHistory {
+public:
+    const MacroDefinition* find(const QString& name, int line, const QHash<QString, MacroTable>& includeMacros) const {
+        int eventLine = -1;
+        const MacroDefinition* found = nullptr;
+        auto events = byName.constFind(name);
+        if (events != byName.constEnd()) {
+            auto it = events->lowerBound(line);
+            if (it != events->constBegin()) {
+                --it;
+                eventLine = it.key();
+                found = it->undefined ? nullptr : &it->macro;
+            }
+        }
+        for (auto it = includes.lowerBound(line); it != includes.constBegin();) {
+            --it;
+            if (it.key() <= eventLine) break;
+            auto table = includeMacros.constFind(it.value());
+            if (table == includeMacros.constEnd()) continue;
+            auto macro = table->constFind(name);
+            if (macro != table->constEnd()) return &macro.value();
+        }
+        return found;
+    }
+    MacroTable table(int line, const QHash<QString, MacroTable>& includeMacros) const {
+        QSet<QString> names;
+        for (auto it = byName.constBegin(); it != byName.constEnd(); ++it) names.insert(it.key());
+        for (auto it = includes.constBegin(); it != includes.constEnd() && it.key() < line; ++it) {
+            const MacroTable included = includeMacros.value(it.value());
+            for (auto macro = included.constBegin(); macro != included.constEnd(); ++macro) names.insert(macro.key());
+        }
+        MacroTable result;
+        for (const QString& name : names) {
+            const MacroDefinition* macro = find(name, line, includeMacros);
+            if (macro) result.insert(name, *macro);
+        }
+        return result;
+    }
+    void apply(int line, const LineEffect& effect, QStringList& changed, bool& includeChanged) {
+        MacroEvent previous = lineEvents.value(line);
+        if (!(previous == effect.event)) {
+            if (!previous.macro.name.isEmpty()) {
+                changed << previous.macro.name;
+                QMap<int, MacroEvent>& events = byName[previous.macro.name];
+                events.remove(line);
+                if (events.isEmpty()) byName.remove(previous.macro.name);
+            }
+            if (effect.event.macro.name.isEmpty()) {
+                lineEvents.remove(line);
+            } else {
+                changed << effect.event.macro.name;
+                lineEvents.insert(line, effect.event);
+                byName[effect.event.macro.name].insert(line, effect.event);
+            }
+        }
+        if (includes.value(line) != effect.include) {
+            includeChanged = true;
+            if (effect.include.isEmpty()) includes.remove(line);
+            else includes.insert(line, effect.include);
+        }
+        if (effect.condition) conditions.insert(line, effect.dependencies);
+        else conditions.remove(line);
+        dirty.remove(line);
+    }
+    void markDependents(int line, const QStringList& names, bool all) {
+        for (auto it = conditions.upperBound(line); it != conditions.constEnd(); ++it) {
+            if (all) {
+                dirty.insert(it.key());
+                continue;
+            }
+            for (const QString& name : names) {
+                if (it->contains(name)) {
+                    dirty.insert(it.key());
+                    break;
+                }
+            }
+        }
+    }
+    QList<int> takeDirty() {
+        QList<int> lines(dirty.begin(), dirty.end());
+        std::sort(lines.begin(), lines.end());
+        dirty.clear();
+        return lines;
+    }
+    QList<int> includeLines(const QSet<QString>& names) const {
+        QList<int> lines;
+        for (auto it = includes.constBegin(); it != includes.constEnd(); ++it) {
+            if (names.contains(it.value())) lines << it.key();
+        }
+        return lines;
+    }
+    void shift(int first, int oldEnd, int delta, QStringList& changed, bool& includeChanged) {
+        for (auto it = lineEvents.constBegin(); it != lineEvents.constEnd(); ++it) {
+            if (it.key() > first && it.key() < oldEnd) changed << it->macro.name;
+        }
+        for (auto it = includes.constBegin(); it != includes.constEnd(); ++it) {
+            if (it.key() > first && it.key() < oldEnd) includeChanged = true;
+        }
+        lineEvents = shifted(lineEvents, first, oldEnd, delta);
+        includes = shifted(includes, first, oldEnd, delta);
+        conditions = shifted(conditions, first, oldEnd, delta);
+        QSet<int> moved;
+        for (int line : dirty) {
+            if (line <= first) moved.insert(line);
+            else if (line >= oldEnd) moved.insert(line + delta);
+        }
+        dirty = moved;
+        byName.clear();
+        for (auto it = lineEvents.constBegin(); it != lineEvents.constEnd(); ++it) {
+            byName[it->macro.name].insert(it.key(), it.value());
+        }
+    }
+private:
+    QMap<int, MacroEvent> lineEvents;
+    QHash<QString, QMap<int, MacroEvent>> byName;
+    QMap<int, QString> includes;
+    QMap<int, QStringList> conditions;
+    QSet<int> dirty;
+
+    template <typename T>
+    static QMap<int, T> shifted(const QMap<int, T>& map, int first, int oldEnd, int delta) {
+        QMap<int, T> result;
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            if (it.key() <= first) result.insert(it.key(), it.value());
+            else if (it.key() >= oldEnd) result.insert(it.key() + delta, it.value());
+        }
+        return result;
+    }
+};
+
+class PreprocessorModel {
+public:
+    static bool isDirective(QStringView line, QString& directive, QStringView& rest) {
+        int pos = 0;
+        while (pos < line.size() && line[pos].isSpace()) ++pos;
+        if (pos >= line.size() || line[pos] != '#') return false;
+        ++pos;
+        while (pos < line.size() && line[pos].isSpace()) ++pos;
+        int start = pos;
+        while (pos < line.size() && line[pos].isLetter()) ++pos;
+        directive = line.mid(start, pos - start).toString();
+        rest = line.mid(pos);
+        return true;
+    }
+    static bool processLine(PreprocessorState& state, QStringView line, const MacroLookup& lookup,
+                            int lineNumber, LineEffect& effect) {
+        if (state.continuation) {
+            QStringView trimmed = line.trimmed();
+            state.continuation = trimmed.endsWith('\\');
+            if (state.pendingDefine.isEmpty()) return state.isActive();
+            state.pendingDefine += ' ' + (state.continuation ? trimmed.chopped(1) : trimmed).toString();
+            if (!state.continuation) define(state, lineNumber, effect);
+            return true;
+        }
+        QString directive;
+        QStringView rest;
+        if (!isDirective(line, directive, rest)) return state.isActive();
+        state.continuation = line.trimmed().endsWith('\\');
+        bool parentActive = state.isActive();
+        auto recorded = [&lookup, &effect](const QString& name) {
+            effect.dependencies << name;
+            return lookup(name);
+        };
+        if (directive == "if") {
+            effect.condition = true;
+            bool value = parentActive && ExpressionEvaluator::evaluate(stripComment(rest), recorded) != 0;
+            state.frames.append(quint8((value ? PreprocessorState::Active | PreprocessorState::Taken : 0)
+                                       | (parentActive ? PreprocessorState::ParentActive : 0)));
+            return parentActive;
+        }
+        if (directive == "elseif" || directive == "else") {
+            if (state.frames.isEmpty()) return parentActive;
+            effect.condition = directive == "elseif";
+            quint8& frame = state.frames.last();
+            bool outer = frame & PreprocessorState::ParentActive;
+            bool taken = frame & PreprocessorState::Taken;
+            bool value = outer && !taken
+                         && (directive == "else" || ExpressionEvaluator::evaluate(stripComment(rest), recorded) != 0);
+            frame = quint8((outer ? PreprocessorState::ParentActive : 0)
+                           | (taken || value ? PreprocessorState::Taken : 0)
+                           | (value ? PreprocessorState::Active : 0));
+            return outer && !state.ended;
+        }
+        if (directive == "endif") {
+            if (!state.frames.isEmpty()) state.frames.removeLast();
+            return state.isActive();
+        }
+        if (!parentActive) return false;
+        if (directive == "define") {
+            state.pendingDefine = rest.trimmed().toString();
+            if (state.continuation) {
+                state.pendingDefine.chop(1);
+            } else {
+                define(state, lineNumber, effect);
+            }
+        } else if (directive == "undef") {
+            QString name = rest.trimmed().toString();
+            int end = 0;
+            while (end < name.size() && PawnLexer::isIdentifierChar(name[end])) ++end;
+            effect.event.macro.name = name.left(end);
+            effect.event.undefined = true;
+        } else if (directive == "include" || directive == "tryinclude") {
+            effect.include = includeName(rest);
+        } else if (directive == "endinput") {
+            state.ended = true;
+        }
+        return true;
+    }
+    static QString includeName(QStringView rest) {
+        QString name = rest.trimmed().toString();
+        if (name.startsWith('<') || name.startsWith('"')) {
+            int end = name.indexOf(name.startsWith('<') ? '>' : '"', 1);
+            return name.mid(1, end < 0 ? -1 : end - 1).trimmed();
+        }
+        int end = 0;
+        while (end < name.size() && !name[end].isSpace()) ++end;
+        return name.left(end);
+    }
+    static MacroTable collectMacros(const QString& text) {
+        MacroTable table;
+        const QStringList lines = text.split('\n');
+        QString pending;
+        for (int i = 0; i < lines.size(); ++i) {
+            QString line = lines[i];
+            if (line.endsWith('\r')) line.chop(1);
+            if (!pending.isEmpty()) {
+                pending += ' ' + line;
+            } else {
+                QString directive;
+                QStringView rest;
+                if (!isDirective(line, directive, rest) || directive != "define") continue;
+                pending = rest.toString();
+            }
+            if (pending.trimmed().endsWith('\\')) {
+                pending = pending.trimmed();
+                pending.chop(1);
+                continue;
+            }
+            MacroDefinition macro;
+            if (MacroDefinition::parse(pending, macro)) {
+                macro.line = i;
+                table.insert(macro.name, macro);
+            }
+            pending.clear();
+        }
+        return table;
+    }
+private:
+    static void define(PreprocessorState& state, int lineNumber, LineEffect& effect) {
+        MacroDefinition macro;
+        if (MacroDefinition::parse(state.pendingDefine, macro)) {
+            macro.line = lineNumber;
+            effect.event.macro = macro;
+        }
+        state.pendingDefine.clear();
+    }
+    static QString stripComment(QStringView text) {
+        QString result = text.toString();
+        int comment = result.indexOf("//");
+        if (comment >= 0) result.truncate(comment);
+        return result;
+    }
+};
+
+class MacroExpander {
+public:
+    MacroExpander(const MacroTable& macroTable) : macros(macroTable) {
+        for (const MacroDefinition& macro : macros) {
+            if (macro.pattern.startsWith('%')) prefixMacros.insert(macro.name);
+        }
+    }
+    QString expand(const QString& source, int* substitutionCount = nullptr) const {
+        QString text = source;
+        int substitutions = 0;
+        int pos = 0;
+        while (pos < text.size() && substitutions < maxSubstitutions) {
+            QChar c = text[pos];
+            if (c == '/' && pos + 1 < text.size() && (text[pos + 1] == '/' || text[pos + 1] == '*')) {
+                pos = skipComment(text, pos);
+                continue;
+            }
+            if (c == '"' || c == '\'') {
+                pos = skipQuoted(text, pos);
+                continue;
+            }
+            if (!PawnLexer::isIdentifierStart(c) || (pos > 0 && PawnLexer::isIdentifierChar(text[pos - 1]))) {
+                ++pos;
+                continue;
+            }
+            int end = pos;
+            while (end < text.size() && PawnLexer::isIdentifierChar(text[end])) ++end;
+            int matchEnd = -1;
+            QString replacement;
+            for (int length = end - pos; length > 0 && matchEnd < 0; --length) {
+                QString name = text.mid(pos, length);
+                if (length < end - pos && !prefixMacros.contains(name)) continue;
+                auto it = macros.constFind(name);
+                if (it == macros.constEnd()) continue;
+                matchEnd = match(text, pos + length, it.value(), replacement);
+            }
+            if (matchEnd < 0) {
+                pos = end;
+                continue;
+            }
+            text.replace(pos, matchEnd - pos, replacement);
+            ++substitutions;
+        }
+        if (substitutionCount) *substitutionCount = substitutions;
+        return text;
+    }
+    static int countTokens(const QString& text) {
+        return PawnLexer::tokenize(text).size();
+    }
+private:
+    static constexpr int maxSubstitutions = 10000;
+    MacroTable macros;
+    QSet<QString> prefixMacros;
+
+    static int skipComment(const QString& text, int pos) {
+        if (text[pos + 1] == '/') {
+            int end = text.indexOf('\n', pos);
+            return end < 0 ? text.size() : end;
+        }
+        int end = text.indexOf("*/", pos + 2);
+        return end < 0 ? text.size() : end + 2;
+    }
+    static int skipQuoted(const QString& text, int pos) {
+        QChar quote = text[pos++];
+        while (pos < text.size() && text[pos] != quote && text[pos] != '\n') {
+            if (text[pos] == '\\') ++pos;
+            ++pos;
+        }
+        return qMin(text.size(), pos + 1);
+    }
+    static int skipBalanced(const QString& text, int pos, QChar stop) {
+        int depth = 0;
+        while (pos < text.size()) {
+            QChar c = text[pos];
+            if (depth == 0 && c == stop) return pos;
+            if (c == '"' || c == '\'') {
+                pos = skipQuoted(text, pos);
+                continue;
+            }
+            if (c == '(' || c == '[' || c == '{') ++depth;
+            else if (c == ')' || c == ']' || c == '}') {
+                if (depth == 0) return -1;
+                --depth;
+            } else if (c == '\n' || c == ';') {
+                if (depth == 0) return -1;
+            }
+            ++pos;
+        }
+        return -1;
+    }
+    static int match(const QString& text, int pos, const MacroDefinition& macro, QString& replacement) {
+        QString arguments[10];
+        const QString& pattern = macro.pattern;
+        int p = 0;
+        while (p < pattern.size()) {
+            QChar c = pattern[p];
+            if (c == '%' && p + 1 < pattern.size() && pattern[p + 1].isDigit()) {
+                int index = pattern[p + 1].digitValue();
+                p += 2;
+                int end;
+                if (p < pattern.size()) {
+                    end = skipBalanced(text, pos, pattern[p]);
+                } else {
+                    end = pos;
+                    while (end < text.size() && (text[end].isSpace() && text[end] != '\n')) ++end;
+                    while (end < text.size() && PawnLexer::isIdentifierChar(text[end])) ++end;
+                }
+                if (end < 0) return -1;
+                arguments[index] = text.mid(pos, end - pos).trimmed();
+                pos = end;
+                continue;
+            }
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+            if (pos >= text.size() || text[pos] != c) return -1;
+            ++pos;
+            ++p;
+        }
+        if (pattern.isEmpty() && pos < text.size() && PawnLexer::isIdentifierChar(text[pos])) return -1;
+        replacement.clear();
+        const QString& body = macro.replacement;
+        for (int i = 0; i < body.size(); ++i) {
+            if (body[i] == '%' && i + 1 < body.size() && body[i + 1].isDigit()) {
+                replacement += arguments[body[i + 1].digitValue()];
+                ++i;
+            } else {
+                replacement += body[i];
+            }
+        }
+        return pos;
+    }
+};
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "includes.h"
+#include "trace.h"
+
+struct ProfileEntry {
+    QString function;
+    QString type;
+    qint64 calls = 0;
+    double selfTime = 0;
+    double totalTime = 0;
+};
+
+struct ProfileData {
+    QString file;
+    QList<ProfileEntry> entries;
+    QString error;
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    double selfTotal() const {
+        double total = 0;
+        for (const ProfileEntry& entry : entries) total += entry.selfTime;
+        return total;
+    }
+    double maxSelf() const {
+        double maximum = 0;
+        for (const ProfileEntry& entry : entries) maximum = qMax(maximum, entry.selfTime);
+        return maximum;
+    }
+    QHash<QString, int> byFunction() const {
+        QHash<QString, int> index;
+        for (int i = 0; i < entries.size(); ++i) index.insert(entries[i].function, i);
+        return index;
+    }
+    static QColor heatColor(double ratio) {
+        static const QColor cold("#4FC1FF");
+        static const QColor warm("#DCDCAA");
+        static const QColor hot("#F44747");
+        ratio = qBound(0.0, ratio, 1.0);
+        const QColor& from = ratio < 0.5 ? cold : warm;
+        const QColor& to = ratio < 0.5 ? warm : hot;
+        double t = ratio < 0.5 ? ratio * 2 : (ratio - 0.5) * 2;
+        return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * t,
+                                from.greenF() + (to.greenF() - from.greenF()) * t,
+                                from.blueF() + (to.blueF() - from.blueF()) * t);
+    }
+};
+
+class ProfileImporter {
+public:
+    static ProfileData load(const QString& path) {
+        PAWNIX_TRACE("loadProfile", "profile");
+        ProfileData data;
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) {
+            data.error = file.errorString();
+            return data;
+        }
+        QByteArray content = file.readAll();
+        data = content.trimmed().startsWith('{') || content.trimmed().startsWith('[') ? parseJson(content) : parseCsv(QString::fromUtf8(content));
+        data.file = path;
+        if (data.error.isEmpty() && data.entries.isEmpty()) data.error = "в файле нет данных о функциях";
+        std::sort(data.entries.begin(), data.entries.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+            return a.selfTime > b.selfTime;
+        });
+        return data;
+    }
+    static ProfileData parseJson(const QByteArray& content) {
+        ProfileData data;
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(content, &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            data.error = parseError.errorString();
+            return data;
+        }
+        QJsonArray items = document.isArray() ? document.array() : document.object().value("functions").toArray();
+        for (const QJsonValue& value : items) {
+            QJsonObject object = value.toObject();
+            ProfileEntry entry;
+            entry.function = firstOf(object, { "name", "function" }).toString();
+            entry.type = object.value("type").toString();
+            entry.calls = firstOf(object, { "calls", "count" }).toInteger();
+            entry.selfTime = firstOf(object, { "self_time", "selfTime", "self" }).toDouble();
+            entry.totalTime = firstOf(object, { "total_time", "totalTime", "total" }).toDouble();
+            if (!entry.function.isEmpty()) data.entries.append(entry);
+        }
+        return data;
+    }
+    static ProfileData parseCsv(const QString& content) {
+        ProfileData data;
+        QStringList lines = content.split('\n');
+        int headerLine = 0;
+        while (headerLine < lines.size() && lines[headerLine].trimmed().isEmpty()) ++headerLine;
+        if (headerLine >= lines.size()) return data;
+        QChar delimiter = lines[headerLine].count(';') > lines[headerLine].count(',') ? ';' : lines[headerLine].contains('\t') ? '\t' : ',';
+        QStringList header = splitLine(lines[headerLine], delimiter);
+        for (QString& name : header) name = name.trimmed().toLower().replace(' ', '_');
+        int nameColumn = column(header, { "name", "function" });
+        int typeColumn = column(header, { "type" });
+        int callsColumn = column(header, { "calls", "count" });
+        int selfColumn = column(header, { "self_time", "selftime", "self" });
+        int totalColumn = column(header, { "total_time", "totaltime", "total" });
+        if (nameColumn < 0) {
+            data.error = "в заголовке CSV нет столбца name/function";
+            return data;
+        }
+        for (int i = headerLine + 1; i < lines.size(); ++i) {
+            if (lines[i].trimmed().isEmpty()) continue;
+            QStringList fields = splitLine(lines[i], delimiter);
+            ProfileEntry entry;
+            entry.function = fields.value(nameColumn).trimmed();
+            entry.type = fields.value(typeColumn).trimmed();
+            entry.calls = fields.value(callsColumn).trimmed().toLongLong();
+            entry.selfTime = number(fields.value(selfColumn));
+            entry.totalTime = number(fields.value(totalColumn));
+            if (!entry.function.isEmpty()) data.entries.append(entry);
+        }
+        return data;
+    }
+private:
+    static QJsonValue firstOf(const QJsonObject& object, std::initializer_list<const char*> keys) {
+        for (const char* key : keys) {
+            if (object.contains(QLatin1String(key))) return object.value(QLatin1String(key));
+        }
+        return QJsonValue();
+    }
+    static int column(const QStringList& header, std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            int index = header.indexOf(QLatin1String(name));
+            if (index >= 0) return index;
+        }
+        return -1;
+    }
+    static double number(QString text) {
+        text = text.trimmed();
+        text.remove('%');
+        text.replace(',', '.');
+        return text.toDouble();
+    }
+    static QStringList splitLine(const QString& line, QChar delimiter) {
+        QStringList fields;
+        QString field;
+        bool quoted = false;
+        for (int i = 0; i < line.size(); ++i) {
+            QChar c = line[i];
+            if (c == '"') {
+                if (quoted && i + 1 < line.size() && line[i + 1] == '"') {
+                    field += c;
+                    ++i;
+                } else {
+                    quoted = !quoted;
+                }
+            } else if (c == delimiter && !quoted) {
+                fields << field;
+                field.clear();
+            } else if (c != '\r') {
+                field += c;
+            }
+        }
+        fields << field;
+        return fields;
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef REFACTORING_H
+#define REFACTORING_H
+
+#include "includes.h"
+#include "pawnlexer.h"
+#include "sourcefile.h"
+#include "symbolindex.h"
+#include "trace.h"
+
+struct RenamePlan {
+    QString file;
+    QVector<IdentifierLocation> locations;
+};
+
+struct RenameResult {
+    QString file;
+    int replaced = 0;
+    bool written = false;
+    QString error;
+};
+
+class RenameRefactoring {
+public:
+    static bool isValidName(const QString& name) {
+        if (name.isEmpty() || !PawnLexer::isIdentifierStart(name[0])) return false;
+        for (QChar c : name) {
+            if (!PawnLexer::isIdentifierChar(c)) return false;
+        }
+        return true;
+    }
+    static const SymbolInfo* enclosingFunction(const QList<SymbolInfo>& symbols, int line) {
+        for (const SymbolInfo& symbol : symbols) {
+            if (symbol.isFunction() && symbol.definition && symbol.endLine > symbol.line
+                && symbol.line <= line && line <= symbol.endLine) return &symbol;
+        }
+        return nullptr;
+    }
+    static bool declaresLocal(const QString& text, const SymbolInfo& function, const QString& name) {
+        QVector<PawnToken> tokens = PawnLexer::tokenize(text);
+        int nesting = 0;
+        int declarationNesting = 0;
+        bool parameters = false;
+        bool parametersSeen = false;
+        bool declaring = false;
+        bool initializer = false;
+        for (int i = 0; i < tokens.size(); ++i) {
+            const PawnToken& token = tokens[i];
+            if (token.line < function.line || (token.line == function.line && token.column <= function.column)) continue;
+            if (token.line > function.endLine) break;
+            if (token.kind == PawnToken::Operator) {
+                QChar c = text[token.start];
+                if (c == '(' && !parametersSeen) {
+                    parameters = parametersSeen = declaring = true;
+                    declarationNesting = nesting;
+                } else if (c == ')' && parameters && nesting == declarationNesting) {
+                    parameters = declaring = initializer = false;
+                } else if (c == '(' || c == '[' || c == '{') {
+                    ++nesting;
+                } else if (c == ')' || c == ']' || c == '}') {
+                    nesting = qMax(0, nesting - 1);
+                } else if (c == '=' && nesting == declarationNesting) {
+                    initializer = true;
+                } else if (c == ',' && nesting == declarationNesting) {
+                    initializer = false;
+                } else if (c == ';' && !parameters) {
+                    declaring = initializer = false;
+                }
+                continue;
+            }
+            if (token.kind != PawnToken::Identifier) continue;
+            QStringView word = QStringView(text).mid(token.start, token.length);
+            if (!parameters && (word == u"new" || word == u"static")) {
+                declaring = true;
+                initializer = false;
+                declarationNesting = nesting;
+                continue;
+            }
+            bool tag = i + 1 < tokens.size() && tokens[i + 1].kind == PawnToken::Operator && text[tokens[i + 1].start] == ':';
+            if (declaring && !initializer && nesting == declarationNesting && !tag && word == name) return true;
+        }
+        return false;
+    }
+    static QList<RenamePlan> plan(const QList<SymbolReference>& references) {
+        QList<RenamePlan> plans;
+        QHash<QString, int> byFile;
+        for (const SymbolReference& reference : references) {
+            auto it = byFile.constFind(reference.file);
+            if (it == byFile.constEnd()) {
+                it = byFile.insert(reference.file, plans.size());
+                plans.append(RenamePlan { reference.file, {} });
+            }
+            plans[it.value()].locations.append(IdentifierLocation { reference.line, reference.column });
+        }
+        return plans;
+    }
+    static QString apply(const QString& text, QVector<IdentifierLocation> locations,
+                         const QString& oldName, const QString& newName, int* replaced = nullptr) {
+        std::sort(locations.begin(), locations.end(), [](const IdentifierLocation& a, const IdentifierLocation& b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+        QString result;
+        result.reserve(text.size() + locations.size() * qMax(0, int(newName.size() - oldName.size())));
+        int count = 0;
+        int line = 0;
+        int lineStart = 0;
+        int copied = 0;
+        for (const IdentifierLocation& location : locations) {
+            while (line < location.line && lineStart >= 0) {
+                lineStart = text.indexOf('\n', lineStart);
+                if (lineStart >= 0) ++lineStart;
+                ++line;
+            }
+            if (lineStart < 0) break;
+            int pos = lineStart + location.column;
+            if (pos < copied || !matchesAt(text, pos, oldName)) continue;
+            result += QStringView(text).mid(copied, pos - copied);
+            result += newName;
+            copied = pos + oldName.size();
+            ++count;
+        }
+        result += QStringView(text).mid(copied);
+        if (replaced) *replaced = count;
+        return result;
+    }
+    static RenameResult rewriteFile(const RenamePlan& plan, const QString& oldName, const QString& newName) {
+        RenameResult result;
+        result.file = plan.file;
+        QString text;
+        if (!SourceFile::read(plan.file, text, &result.error)) return result;
+        QString renamed = apply(text, plan.locations, oldName, newName, &result.replaced);
+        if (result.replaced == 0) return result;
+        QSaveFile file(plan.file);
+        if (!file.open(QFile::WriteOnly)) {
+            result.error = file.errorString();
+            return result;
+        }
+        file.write(SourceFile::encode(renamed));
+        if (!file.commit()) {
+            result.error = file.errorString();
+            return result;
+        }
+        result.written = true;
+        return result;
+    }
+    static QList<RenameResult> rewriteFiles(const QList<RenamePlan>& plans, const QString& oldName, const QString& newName) {
+        PAWNIX_TRACE("rewriteFiles", "refactoring");
+        return QtConcurrent::blockingMapped(plans, [oldName, newName](const RenamePlan& plan) {
+            return rewriteFile(plan, oldName, newName);
+        });
+    }
+    static bool matchesAt(const QString& text, int pos, const QString& name) {
+        if (pos < 0 || pos + name.size() > text.size()) return false;
+        if (QStringView(text).mid(pos, name.size()) != name) return false;
+        if (pos > 0 && PawnLexer::isIdentifierChar(text[pos - 1])) return false;
+        int end = pos + name.size();
+        return end >= text.size() || !PawnLexer::isIdentifierChar(text[end]);
+    }
+};
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef SERVERTARGET_H
+#define SERVERTARGET_H
+
+#include "includes.h"
+#include "trace.h"
+
+struct LogLine {
+    enum Kind { Normal, Warning, Error };
+    QString text;
+    Kind kind = Normal;
+    QString file;
+    int line = -1;
+};
+
+class RuntimeErrorParser {
+public:
+    static LogLine parse(const QString& text) {
+        static const QRegularExpression location("\\bat\\s+(.+\\.(?:pwn|inc|p)):(\\d+)", QRegularExpression::CaseInsensitiveOption);
+        LogLine line;
+        line.text = text;
+        if (text.contains("Run time error", Qt::CaseInsensitive) || text.contains("[error]", Qt::CaseInsensitive)) {
+            line.kind = LogLine::Error;
+        } else if (text.contains("[warning]", Qt::CaseInsensitive) || text.contains("Warning:", Qt::CaseInsensitive)) {
+            line.kind = LogLine::Warning;
+        }
+        QRegularExpressionMatch match = location.match(text);
+        if (match.hasMatch()) {
+            line.file = match.captured(1).trimmed();
+            line.line = match.captured(2).toInt();
+            if (line.kind == LogLine::Normal) line.kind = LogLine::Error;
+        }
+        return line;
+    }
+};
+
+class LogModel : public QAbstractListModel {
+public:
+    LogModel(int maximumLines, QObject* parent = nullptr) : QAbstractListModel(parent), capacity(maximumLines) {}
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : lines.size();
+    }
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (!index.isValid() || index.row() >= lines.size()) return QVariant();
+        const LogLine& line = lines[index.row()];
+        switch (role) {
+        case Qt::DisplayRole:
+            return line.text;
+        case Qt::ForegroundRole:
+            return line.kind == LogLine::Error ? QColor("#F14C4C") : line.kind == LogLine::Warning ? QColor("#D7BA7D") : QColor("#D4D4D4");
+        case Qt::UserRole:
+            return line.file;
+        case Qt::UserRole + 1:
+            return line.line;
+        }
+        return QVariant();
+    }
+    void append(QList<LogLine> incoming) {
+        PAWNIX_TRACE("appendLog", "server");
+        if (incoming.isEmpty()) return;
+        if (incoming.size() > capacity) incoming = incoming.mid(incoming.size() - capacity);
+        int overflow = lines.size() + incoming.size() - capacity;
+        if (overflow > 0) {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            lines.remove(0, overflow);
+            endRemoveRows();
+        }
+        beginInsertRows(QModelIndex(), lines.size(), lines.size() + incoming.size() - 1);
+        lines.append(incoming);
+        endInsertRows();
+    }
+    void clear() {
+        beginResetModel();
+        lines.clear();
+        endResetModel();
+    }
+private:
+    QList<LogLine> lines;
+    int capacity;
+};
+
+class ServerProcess : public QObject {
+    Q_OBJECT
+public:
+    ServerProcess(QObject* parent = nullptr) : QObject(parent) {
+        flushTimer.setSingleShot(true);
+        flushTimer.setInterval(50);
+        connect(&flushTimer, &QTimer::timeout, this, &ServerProcess::flush);
+        tailTimer.setInterval(250);
+        connect(&tailTimer, &QTimer::timeout, this, &ServerProcess::readLog);
+    }
+    ~ServerProcess() {
+        if (isRunning()) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+    bool isRunning() const { return process && process->state() != QProcess::NotRunning; }
+    QString executable() const { return program; }
+    void start(const QString& executablePath, const QString& logPath) {
+        if (process) {
+            process->disconnect(this);
+            if (isRunning()) {
+                process->kill();
+                process->waitForFinished(1000);
+            }
+            process->deleteLater();
+        }
+        program = executablePath;
+        logFile = logPath;
+        outputBuffer.clear();
+        logBuffer.clear();
+        logOffset = logFile.isEmpty() ? 0 : QFileInfo(logFile).size();
+        process = new QProcess(this);
+        process->setWorkingDirectory(QFileInfo(program).absolutePath());
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        connect(process, &QProcess::readyReadStandardOutput, this, [this]() {
+            outputBuffer += process->readAllStandardOutput();
+            scheduleFlush();
+        });
+        connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                tailTimer.stop();
+                emit stopped(-1, process->errorString());
+            }
+        });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+            tailTimer.stop();
+            readLog();
+            flush();
+            emit stopped(exitCode, exitStatus == QProcess::CrashExit ? "аварийное завершение" : QString());
+        });
+        process->start(program, QStringList());
+        if (!logFile.isEmpty()) tailTimer.start();
+    }
+    void stop() {
+        if (!isRunning()) return;
+        sendCommand("exit");
+        QTimer::singleShot(3000, process, [process = process]() {
+            if (process->state() != QProcess::NotRunning) process->kill();
+        });
+    }
+    void sendCommand(const QString& command) {
+        if (!isRunning()) return;
+        process->write((command + "\n").toLocal8Bit());
+    }
+signals:
+    void linesReady(const QList<LogLine>& lines);
+    void stopped(int exitCode, const QString& error);
+private:
+    QPointer<QProcess> process;
+    QString program;
+    QString logFile;
+    qint64 logOffset = 0;
+    QByteArray outputBuffer;
+    QByteArray logBuffer;
+    QTimer flushTimer;
+    QTimer tailTimer;
+
+    void scheduleFlush() {
+        if (!flushTimer.isActive()) flushTimer.start();
+    }
+    void readLog() {
+        QFile file(logFile);
+        if (!file.open(QFile::ReadOnly)) return;
+        if (file.size() < logOffset) logOffset = 0;
+        if (file.size() == logOffset) return;
+        file.seek(logOffset);
+        logBuffer += file.readAll();
+        logOffset = file.pos();
+        scheduleFlush();
+    }
+    static void takeLines(QByteArray& buffer, QList<LogLine>& lines, const QString& prefix, bool all) {
+        int end = buffer.lastIndexOf('\n');
+        if (all) end = buffer.size();
+        if (end < 0) return;
+        for (const QByteArray& raw : buffer.left(end).split('\n')) {
+            QString text = QString::fromLocal8Bit(raw).trimmed();
+            if (!text.isEmpty()) lines.append(RuntimeErrorParser::parse(prefix + text));
+        }
+        buffer.remove(0, qMin(end + 1, int(buffer.size())));
+    }
+    void flush() {
+        PAWNIX_TRACE("flushServerOutput", "server");
+        bool finished = !isRunning();
+        QList<LogLine> lines;
+        takeLines(outputBuffer, lines, QString(), finished);
+        takeLines(logBuffer, lines, "[log] ", finished);
+        if (!lines.isEmpty()) emit linesReady(lines);
+    }
+};
+
+#endif
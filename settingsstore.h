@@ -0,0 +1,103 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include "includes.h"
+#include "trace.h"
+
+class SettingsStore : public QObject {
+public:
+    SettingsStore(const QString& organizationName, const QString& applicationName, QObject* parent = nullptr)
+        : QObject(parent), organization(organizationName), application(applicationName) {
+        QSettings settings(organization, application);
+        for (const QString& key : settings.allKeys()) {
+            values.insert(key, settings.value(key));
+        }
+        writer.setMaxThreadCount(1);
+        flushTimer.setSingleShot(true);
+        flushTimer.setInterval(1000);
+        connect(&flushTimer, &QTimer::timeout, this, &SettingsStore::flush);
+    }
+    ~SettingsStore() {
+        sync();
+    }
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const {
+        return values.value(key, defaultValue);
+    }
+    void setValue(const QString& key, const QVariant& value) {
+        auto it = values.constFind(key);
+        if (it != values.constEnd() && it.value() == value) return;
+        values.insert(key, value);
+        pending.insert(key, value);
+        flushTimer.start();
+    }
+    QVariant projectValue(const QString& key, const QVariant& defaultValue = QVariant()) const {
+        return project.contains(key) ? project.value(key).toVariant() : defaultValue;
+    }
+    void setProjectValue(const QString& key, const QVariant& value) {
+        if (projectFile.isEmpty()) return;
+        QJsonValue jsonValue = QJsonValue::fromVariant(value);
+        if (project.value(key) == jsonValue) return;
+        project.insert(key, jsonValue);
+        projectDirty = true;
+        flushTimer.start();
+    }
+    QString projectPath() const { return projectFile; }
+    void openWorkspace(const QString& folder) {
+        if (projectDirty) flush();
+        project = QJsonObject();
+        projectDirty = false;
+        projectFile = folder.isEmpty() ? QString() : QDir(folder).filePath(".pawnix/workspace.json");
+        if (projectFile.isEmpty()) return;
+        QFile file(projectFile);
+        if (file.open(QFile::ReadOnly)) {
+            project = QJsonDocument::fromJson(file.readAll()).object();
+        }
+    }
+    void flush() {
+        flushTimer.stop();
+        if (!pending.isEmpty()) {
+            QVariantMap batch = pending;
+            pending.clear();
+            QString org = organization;
+            QString app = application;
+            writer.start([batch, org, app]() {
+                PAWNIX_TRACE("flushSettings", "settings");
+                QSettings settings(org, app);
+                for (auto it = batch.constBegin(); it != batch.constEnd(); ++it) {
+                    settings.setValue(it.key(), it.value());
+                }
+                settings.sync();
+            });
+        }
+        if (projectDirty) {
+            projectDirty = false;
+            QByteArray data = QJsonDocument(project).toJson(QJsonDocument::Indented);
+            QString path = projectFile;
+            writer.start([data, path]() {
+                PAWNIX_TRACE("flushProject", "settings");
+                QDir().mkpath(QFileInfo(path).absolutePath());
+                QSaveFile file(path);
+                if (file.open(QFile::WriteOnly)) {
+                    file.write(data);
+                    file.commit();
+                }
+            });
+        }
+    }
+    void sync() {
+        flush();
+        writer.waitForDone();
+    }
+private:
+    QString organization;
+    QString application;
+    QVariantMap values;
+    QVariantMap pending;
+    QString projectFile;
+    QJsonObject project;
+    bool projectDirty = false;
+    QTimer flushTimer;
+    QThreadPool writer;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef SOURCEFILE_H
+#define SOURCEFILE_H
+
+#include "includes.h"
+
+class SourceFile {
+public:
+    static QTextCodec* codec() {
+        static QTextCodec* windows1251 = QTextCodec::codecForName("Windows-1251");
+        return windows1251;
+    }
+    static QString decode(const QByteArray& data) {
+        QTextCodec* textCodec = codec();
+        return textCodec ? textCodec->toUnicode(data) : QString::fromLocal8Bit(data);
+    }
+    static QByteArray encode(const QString& text) {
+        QTextCodec* textCodec = codec();
+        return textCodec ? textCodec->fromUnicode(text) : text.toLocal8Bit();
+    }
+    static bool read(const QString& fileName, QString& text, QString* error = nullptr) {
+        QFile file(fileName);
+        if (!file.open(QFile::ReadOnly)) {
+            if (error) *error = file.errorString();
+            return false;
+        }
+        text = decode(file.readAll());
+        return true;
+    }
+};
+
+#endif
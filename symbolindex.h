@@ -0,0 +1,378 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include "includes.h"
+#include "pawnlexer.h"
+#include "sourcefile.h"
+
+struct SymbolInfo {
+    enum Kind { Function, Public, Stock, Static, Native, Forward, Define, Enum, Constant, Variable, Tag };
+    QString name;
+    Kind kind = Function;
+    QString file;
+    int line = 0;
+    int column = 0;
+    int endLine = 0;
+    bool definition = true;
+    QString signature;
+    bool isFunction() const {
+        return kind == Function || kind == Public || kind == Stock || kind == Static || kind == Native || kind == Forward;
+    }
+    static QString kindName(Kind kind) {
+        static const char* names[] = {
+            "function", "public", "stock", "static", "native", "forward",
+            "define", "enum", "constant", "variable", "tag"
+        };
+        return QString::fromLatin1(names[kind]);
+    }
+    QJsonObject toJson() const {
+        QJsonObject object;
+        object["name"] = name;
+        object["kind"] = kindName(kind);
+        object["file"] = file;
+        object["line"] = line + 1;
+        object["column"] = column + 1;
+        if (endLine > line) object["endLine"] = endLine + 1;
+        object["definition"] = definition;
+        if (!signature.isEmpty()) object["signature"] = signature;
+        return object;
+    }
+};
+
+using SemanticTable = QHash<QString, SymbolInfo::Kind>;
+
+class SymbolParser {
+public:
+    static QList<SymbolInfo> parse(const QString& text, const QString& filePath) {
+        SymbolParser parser(text, filePath);
+        parser.run();
+        return parser.symbols;
+    }
+private:
+    SymbolParser(const QString& source, const QString& path)
+        : text(source), file(path), tokens(PawnLexer::tokenize(source)) {}
+    const QString& text;
+    QString file;
+    QVector<PawnToken> tokens;
+    QList<SymbolInfo> symbols;
+    QSet<QString> tags;
+
+    QStringView tokenText(int index) const {
+        const PawnToken& token = tokens[index];
+        return QStringView(text).mid(token.start, token.length);
+    }
+    bool isOperator(int index, QChar c) const {
+        return index >= 0 && index < tokens.size() && tokens[index].kind == PawnToken::Operator && text[tokens[index].start] == c;
+    }
+    int matchingParen(int open) const {
+        int depth = 0;
+        for (int i = open; i < tokens.size(); ++i) {
+            if (isOperator(i, '(')) ++depth;
+            else if (isOperator(i, ')') && --depth == 0) return i;
+            else if (isOperator(i, '{') || isOperator(i, ';')) return -1;
+        }
+        return -1;
+    }
+    SymbolInfo makeSymbol(int index, SymbolInfo::Kind kind) const {
+        SymbolInfo symbol;
+        symbol.name = tokenText(index).toString();
+        symbol.kind = kind;
+        symbol.file = file;
+        symbol.line = tokens[index].line;
+        symbol.column = tokens[index].column;
+        symbol.endLine = symbol.line;
+        return symbol;
+    }
+    QString restOfLine(int index) const {
+        int start = tokens[index].start;
+        int end = text.indexOf('\n', start);
+        if (end < 0) end = text.size();
+        return text.mid(start, end - start).simplified();
+    }
+    void run() {
+        int depth = 0;
+        int parenDepth = 0;
+        int directiveLine = -1;
+        int enumDepth = -1;
+        int openFunction = -1;
+        int lastLine = -1;
+        bool statementStart = true;
+        bool declaring = false;
+        bool expectEnumItem = false;
+        QStringList specifiers;
+        for (int i = 0; i < tokens.size(); ++i) {
+            const PawnToken& token = tokens[i];
+            if (token.line == directiveLine) continue;
+            if (token.kind == PawnToken::Directive) {
+                directiveLine = token.line;
+                QString directive = tokenText(i).mid(1).trimmed().toString();
+                if (directive == "define" && i + 1 < tokens.size() && tokens[i + 1].line == token.line
+                    && tokens[i + 1].kind == PawnToken::Identifier) {
+                    SymbolInfo symbol = makeSymbol(i + 1, SymbolInfo::Define);
+                    symbol.signature = restOfLine(i);
+                    symbols.append(symbol);
+                }
+                continue;
+            }
+            if (depth == 0 && parenDepth == 0 && token.line != lastLine && lastLine >= 0) {
+                QChar last = text[tokens[i - 1].start];
+                if (last != ',' && last != '=' && last != '(' && (specifiers.isEmpty() || declaring)) {
+                    statementStart = true;
+                    declaring = false;
+                    specifiers.clear();
+                }
+            }
+            lastLine = token.line;
+            if (token.kind == PawnToken::Operator) {
+                QChar c = text[token.start];
+                if (c == '{') {
+                    ++depth;
+                    if (specifiers.contains("enum") && enumDepth < 0) {
+                        enumDepth = depth;
+                        expectEnumItem = true;
+                    }
+                } else if (c == '}') {
+                    if (depth == enumDepth) enumDepth = -1;
+                    depth = qMax(0, depth - 1);
+                    if (depth == 0) {
+                        if (openFunction >= 0) {
+                            symbols[openFunction].endLine = token.line;
+                            openFunction = -1;
+                        }
+                        statementStart = true;
+                        declaring = false;
+                        specifiers.clear();
+                    }
+                } else if (c == '(') {
+                    ++parenDepth;
+                } else if (c == ')') {
+                    parenDepth = qMax(0, parenDepth - 1);
+                } else if (c == ';' && depth == 0) {
+                    statementStart = true;
+                    declaring = false;
+                    specifiers.clear();
+                } else if (c == ',' && depth == enumDepth) {
+                    expectEnumItem = true;
+                }
+                continue;
+            }
+            if (token.kind != PawnToken::Identifier) continue;
+            QStringView word = tokenText(i);
+            bool tagged = isOperator(i + 1, ':') && tokens[i + 1].start == token.start + token.length
+                          && !isOperator(i + 2, ':') && !isOperator(i - 1, '?') && word != u"default"
+                          && !(i > 0 && tokens[i - 1].kind == PawnToken::Identifier && tokenText(i - 1) == u"case");
+            if (tagged) {
+                if (!tags.contains(word.toString())) {
+                    tags.insert(word.toString());
+                    symbols.append(makeSymbol(i, SymbolInfo::Tag));
+                }
+                ++i;
+                continue;
+            }
+            if (enumDepth >= 0 && depth == enumDepth) {
+                if (expectEnumItem) {
+                    symbols.append(makeSymbol(i, SymbolInfo::Constant));
+                    expectEnumItem = false;
+                }
+                continue;
+            }
+            if (depth != 0) continue;
+            static const QStringList keywords { "public", "stock", "native", "forward", "static", "const", "new", "enum", "operator" };
+            if (keywords.contains(word.toString())) {
+                specifiers << word.toString();
+                statementStart = false;
+                continue;
+            }
+            if (declaring) {
+                if (parenDepth == 0 && isOperator(i - 1, ',')) {
+                    symbols.append(makeSymbol(i, specifiers.contains("const") ? SymbolInfo::Constant : SymbolInfo::Variable));
+                }
+                continue;
+            }
+            if (specifiers.contains("operator")) continue;
+            if (isOperator(i + 1, '(') && parenDepth == 0 && (statementStart || !specifiers.isEmpty())
+                && !specifiers.contains("new") && !specifiers.contains("enum")) {
+                int close = matchingParen(i + 1);
+                if (close < 0) {
+                    statementStart = false;
+                    continue;
+                }
+                SymbolInfo::Kind kind = SymbolInfo::Function;
+                if (specifiers.contains("native")) kind = SymbolInfo::Native;
+                else if (specifiers.contains("forward")) kind = SymbolInfo::Forward;
+                else if (specifiers.contains("public")) kind = SymbolInfo::Public;
+                else if (specifiers.contains("stock")) kind = SymbolInfo::Stock;
+                else if (specifiers.contains("static")) kind = SymbolInfo::Static;
+                SymbolInfo symbol = makeSymbol(i, kind);
+                symbol.signature = text.mid(token.start, tokens[close].start + 1 - token.start).simplified();
+                bool hasBody = isOperator(close + 1, '{');
+                symbol.definition = kind != SymbolInfo::Forward && (kind == SymbolInfo::Native || hasBody);
+                if (kind == SymbolInfo::Function && !hasBody) {
+                    statementStart = false;
+                    i = close;
+                    continue;
+                }
+                symbols.append(symbol);
+                if (hasBody && kind != SymbolInfo::Native && kind != SymbolInfo::Forward) {
+                    openFunction = symbols.size() - 1;
+                }
+                i = close;
+                parenDepth = 0;
+                statementStart = false;
+                specifiers.clear();
+                continue;
+            }
+            if (statementStart && specifiers.isEmpty() && i + 1 < tokens.size()
+                && tokens[i + 1].kind == PawnToken::Identifier && tokens[i + 1].line == token.line) {
+                continue;
+            }
+            if (specifiers.contains("enum")) {
+                symbols.append(makeSymbol(i, SymbolInfo::Enum));
+            } else if (specifiers.contains("new") || specifiers.contains("static") || specifiers.contains("const")) {
+                symbols.append(makeSymbol(i, specifiers.contains("const") && !specifiers.contains("new")
+                                                 ? SymbolInfo::Constant : SymbolInfo::Variable));
+                declaring = true;
+            }
+            statementStart = false;
+        }
+    }
+};
+
+struct IdentifierLocation {
+    int line;
+    int column;
+};
+
+using FileReferences = QHash<QString, QVector<IdentifierLocation>>;
+
+struct SymbolReference {
+    QString file;
+    int line = 0;
+    int column = 0;
+    int length = 0;
+};
+
+class ReferenceIndex {
+public:
+    static FileReferences scan(const QString& text) {
+        FileReferences references;
+        for (const PawnToken& token : PawnLexer::tokenize(text)) {
+            if (token.kind != PawnToken::Identifier) continue;
+            references[text.mid(token.start, token.length)].append(IdentifierLocation { token.line, token.column });
+        }
+        return references;
+    }
+    void update(const QString& filePath, const FileReferences& references) {
+        remove(filePath);
+        namesByFile.insert(filePath, references.keys());
+        for (auto it = references.constBegin(); it != references.constEnd(); ++it) {
+            byName[it.key()].insert(filePath, it.value());
+        }
+    }
+    void remove(const QString& filePath) {
+        auto it = namesByFile.find(filePath);
+        if (it == namesByFile.end()) return;
+        for (const QString& name : it.value()) {
+            auto named = byName.find(name);
+            if (named == byName.end()) continue;
+            named->remove(filePath);
+            if (named->isEmpty()) byName.erase(named);
+        }
+        namesByFile.erase(it);
+    }
+    QList<SymbolReference> references(const QString& name) const {
+        QList<SymbolReference> result;
+        auto named = byName.constFind(name);
+        if (named == byName.constEnd()) return result;
+        QStringList filePaths = named->keys();
+        filePaths.sort();
+        for (const QString& filePath : filePaths) {
+            for (const IdentifierLocation& location : named->value(filePath)) {
+                result.append(SymbolReference { filePath, location.line, location.column, int(name.size()) });
+            }
+        }
+        return result;
+    }
+    QStringList filesReferencing(const QString& name) const {
+        return byName.value(name).keys();
+    }
+private:
+    QHash<QString, QHash<QString, QVector<IdentifierLocation>>> byName;
+    QHash<QString, QStringList> namesByFile;
+};
+
+class SymbolIndex {
+public:
+    void update(const QString& filePath, const QList<SymbolInfo>& symbols) {
+        remove(filePath);
+        byFile.insert(filePath, symbols);
+        for (const SymbolInfo& symbol : symbols) {
+            byName[symbol.name].append(symbol);
+        }
+    }
+    void remove(const QString& filePath) {
+        auto it = byFile.find(filePath);
+        if (it == byFile.end()) return;
+        for (const SymbolInfo& symbol : it.value()) {
+            auto named = byName.find(symbol.name);
+            if (named == byName.end()) continue;
+            named->removeIf([&](const SymbolInfo& other) { return other.file == filePath; });
+            if (named->isEmpty()) byName.erase(named);
+        }
+        byFile.erase(it);
+    }
+    QList<SymbolInfo> find(const QString& name) const {
+        return byName.value(name);
+    }
+    QList<SymbolInfo> symbolsInFile(const QString& filePath) const {
+        return byFile.value(filePath);
+    }
+    QList<SymbolInfo> search(const QString& query, int limit = 100) const {
+        QList<SymbolInfo> prefix;
+        QList<SymbolInfo> contains;
+        for (auto it = byName.constBegin(); it != byName.constEnd(); ++it) {
+            int position = it.key().indexOf(query, 0, Qt::CaseInsensitive);
+            if (position < 0) continue;
+            (position == 0 ? prefix : contains).append(it.value());
+        }
+        auto byNameOrder = [](const SymbolInfo& a, const SymbolInfo& b) {
+            return a.name.compare(b.name, Qt::CaseInsensitive) < 0;
+        };
+        std::sort(prefix.begin(), prefix.end(), byNameOrder);
+        std::sort(contains.begin(), contains.end(), byNameOrder);
+        prefix.append(contains);
+        return prefix.mid(0, limit);
+    }
+    QStringList files() const { return byFile.keys(); }
+    int fileCount() const { return byFile.size(); }
+    int symbolCount() const {
+        int total = 0;
+        for (const auto& symbols : byFile) total += symbols.size();
+        return total;
+    }
+    void indexFiles(const QStringList& filePaths) {
+        QList<QList<SymbolInfo>> parsed = QtConcurrent::blockingMapped(filePaths, [](const QString& filePath) {
+            QString text;
+            if (!SourceFile::read(filePath, text)) return QList<SymbolInfo>();
+            return SymbolParser::parse(text, filePath);
+        });
+        for (int i = 0; i < filePaths.size(); ++i) {
+            update(filePaths[i], parsed[i]);
+        }
+    }
+    static QStringList workspaceFiles(const QString& root) {
+        QStringList result;
+        QDirIterator it(root, QStringList() << "*.pwn" << "*.inc" << "*.p" << "*.pawn",
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            result.append(QFileInfo(it.next()).absoluteFilePath());
+        }
+        result.sort();
+        return result;
+    }
+private:
+    QHash<QString, QList<SymbolInfo>> byFile;
+    QHash<QString, QList<SymbolInfo>> byName;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include <QtTest>
+#include "tst_amx.h"
+#include "tst_headless.h"
+#include "tst_linediff.h"
+#include "tst_preprocessor.h"
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+    int status = 0;
+    {
+        AmxTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        HeadlessTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        LineDiffTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        PreprocessorTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    return status;
+}
@@ -0,0 +1,30 @@
+QT += widgets core5compat core gui concurrent testlib
+CONFIG += console testcase
+CONFIG -= app_bundle
+TARGET = pawnix_tests
+TEMPLATE = app
+INCLUDEPATH += ..
+DEFINES += PAWNIX_TESTS_DIR=\\\"$$PWD\\\"
+
+win32 {
+    QMAKE_CXXFLAGS += -finput-charset=UTF-8 -fexec-charset=UTF-8
+}
+
+SOURCES += main.cpp
+HEADERS += tst_amx.h \
+           tst_headless.h \
+           tst_linediff.h \
+           tst_preprocessor.h \
+           ../includes.h \
+           ../headless.h \
+           ../analysis.h \
+           ../buildpipeline.h \
+           ../sourcefile.h \
+           ../pawnlexer.h \
+           ../symbolindex.h \
+           ../preprocessor.h \
+           ../lint.h \
+           ../amx.h \
+           ../codeeditor.h \
+           ../gitdiff.h \
+           ../trace.h
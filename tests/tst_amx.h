@@ -0,0 +1,85 @@
+#ifndef TST_AMX_H
+#define TST_AMX_H
+
+#include <QtTest>
+#include "includes.h"
+#include "amx.h"
+
+class AmxTest : public QObject {
+    Q_OBJECT
+private:
+    static void write16(QByteArray& data, int offset, quint16 value) {
+        qToLittleEndian(value, data.data() + offset);
+    }
+    static void write32(QByteArray& data, int offset, qint32 value) {
+        qToLittleEndian(value, data.data() + offset);
+    }
+    static QByteArray image(qint32 publics = 56, qint32 natives = 64, qint32 nameOffset = 66) {
+        QByteArray data(85, '\0');
+        write16(data, 4, 0xF1E0);
+        data[6] = 11;
+        data[7] = 11;
+        write16(data, 10, 8);
+        write32(data, 12, 73);
+        write32(data, 16, 81);
+        write32(data, 20, 85);
+        write32(data, 24, 101);
+        write32(data, 32, publics);
+        write32(data, 36, natives);
+        for (int offset = 40; offset <= 52; offset += 4) write32(data, offset, 64);
+        write32(data, 60, nameOffset);
+        write16(data, 64, 31);
+        data.replace(66, 7, QByteArray("OnInit", 7));
+        return data;
+    }
+private slots:
+    void parsesTables() {
+        AmxInfo info = AmxInfo::parse(image());
+        QVERIFY2(info.valid, qPrintable(info.error));
+        QCOMPARE(info.cellSize, 4);
+        QCOMPARE(info.codeSize, qint64(8));
+        QCOMPARE(info.dataSize, qint64(4));
+        QCOMPARE(info.stackHeapSize, qint64(16));
+        QCOMPARE(info.publics, QStringList() << "OnInit");
+        QVERIFY(info.natives.isEmpty());
+    }
+    void rejectsShortFile() {
+        AmxInfo info = AmxInfo::parse(image().left(40));
+        QVERIFY(!info.valid);
+        QVERIFY(!info.error.isEmpty());
+    }
+    void rejectsUnknownMagic() {
+        QByteArray data = image();
+        write16(data, 4, 0x1234);
+        AmxInfo info = AmxInfo::parse(data);
+        QVERIFY(!info.valid);
+        QVERIFY(info.error.contains("0x1234"));
+    }
+    void rejectsMalformedHeader() {
+        QByteArray data = image();
+        write32(data, 16, 60);
+        AmxInfo info = AmxInfo::parse(data);
+        QVERIFY(!info.valid);
+        QVERIFY(!info.error.isEmpty());
+        data = image();
+        write32(data, 12, 4096);
+        QVERIFY(!AmxInfo::parse(data).valid);
+        data = image();
+        write16(data, 10, 0);
+        QVERIFY(!AmxInfo::parse(data).valid);
+    }
+    void skipsOutOfRangeTables() {
+        AmxInfo info = AmxInfo::parse(image(8, 4096));
+        QVERIFY2(info.valid, qPrintable(info.error));
+        QVERIFY(info.publics.isEmpty());
+        QVERIFY(info.natives.isEmpty());
+        QVERIFY(info.libraries.isEmpty());
+    }
+    void skipsNamesOutsideFile() {
+        QVERIFY(AmxInfo::parse(image(56, 64, 12)).publics.isEmpty());
+        QVERIFY(AmxInfo::parse(image(56, 64, -4)).publics.isEmpty());
+        QVERIFY(AmxInfo::parse(image(56, 64, 4096)).publics.isEmpty());
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef TST_HEADLESS_H
+#define TST_HEADLESS_H
+
+#include <QtTest>
+#include "includes.h"
+#include "headless.h"
+
+class HeadlessTest : public QObject {
+    Q_OBJECT
+private:
+    QTemporaryDir workspace;
+
+    QString stubCompiler() const {
+        return QString(PAWNIX_TESTS_DIR) + "/stub/pawncc";
+    }
+    QString writeSource(const QString& name, const QString& text) {
+        QString path = workspace.filePath(name);
+        QFile file(path);
+        file.open(QFile::WriteOnly | QFile::Truncate);
+        file.write(text.toUtf8());
+        return path;
+    }
+    int runBuild(const QString& target, const QString& compiler, QJsonObject* report = nullptr) {
+        HeadlessRunner runner(QStringList() << "PawniX" << "--build" << target << "--compiler" << compiler);
+        int exitCode = runner.run();
+        if (report) *report = runner.report();
+        return exitCode;
+    }
+private slots:
+    void initTestCase() {
+#ifdef Q_OS_WIN
+        QSKIP("the stub compiler is a POSIX shell script");
+#endif
+        QVERIFY(workspace.isValid());
+        QVERIFY(QFileInfo(stubCompiler()).isExecutable());
+    }
+    void helpExitsWithSuccess() {
+        QCOMPARE(HeadlessRunner(QStringList() << "PawniX" << "--help").run(), int(HeadlessRunner::Success));
+    }
+    void unknownArgumentIsUsageError() {
+        QCOMPARE(HeadlessRunner(QStringList() << "PawniX" << "--frobnicate").run(), int(HeadlessRunner::UsageError));
+    }
+    void cleanBuildSucceeds() {
+        QString source = writeSource("clean.pwn", "main()\n{\n}\n");
+        QJsonObject report;
+        QCOMPARE(runBuild(source, stubCompiler(), &report), int(HeadlessRunner::Success));
+        QJsonObject entry = report["results"].toArray().first().toObject();
+        QVERIFY(entry["success"].toBool());
+        QVERIFY(entry["diagnostics"].toArray().isEmpty());
+        QVERIFY(QFileInfo(workspace.filePath("clean.amx")).isFile());
+    }
+    void warningsDoNotFailBuild() {
+        QString source = writeSource("warning.pwn", "// stub:warning\nmain()\n{\n}\n");
+        QJsonObject report;
+        QCOMPARE(runBuild(source, stubCompiler(), &report), int(HeadlessRunner::Success));
+        QJsonArray diagnostics = report["results"].toArray().first().toObject()["diagnostics"].toArray();
+        QCOMPARE(diagnostics.size(), 1);
+        QJsonObject warning = diagnostics.first().toObject();
+        QCOMPARE(warning["severity"].toString(), QString("warning"));
+        QCOMPARE(warning["code"].toInt(), 203);
+        QCOMPARE(warning["line"].toInt(), 5);
+        QCOMPARE(warning["endLine"].toInt(), 6);
+    }
+    void errorsFailBuild() {
+        QString source = writeSource("broken.pwn", "// stub:error\nmain()\n{\n}\n");
+        QJsonObject report;
+        QCOMPARE(runBuild(source, stubCompiler(), &report), int(HeadlessRunner::Failed));
+        QVERIFY(!report["success"].toBool());
+        QJsonArray diagnostics = report["results"].toArray().first().toObject()["diagnostics"].toArray();
+        QCOMPARE(diagnostics.size(), 2);
+        QJsonObject error = diagnostics.first().toObject();
+        QCOMPARE(error["severity"].toString(), QString("error"));
+        QCOMPARE(error["code"].toInt(), 17);
+        QCOMPARE(error["line"].toInt(), 3);
+        QCOMPARE(QFileInfo(error["file"].toString()).fileName(), QString("broken.pwn"));
+        QCOMPARE(error["message"].toString(), QString("undefined symbol \"missing\""));
+    }
+    void lintSeesIncludeMacros() {
+        QVERIFY(QDir(workspace.path()).mkpath("libs"));
+        writeSource("libs/buffers.inc", "#define BUFFER_SIZE 4096\n");
+        QString source = writeSource("buffers.pwn", "#include <buffers>\nmain()\n{\n    new buffer[BUFFER_SIZE];\n}\n");
+        QString libs = workspace.filePath("libs");
+        HeadlessRunner lint(QStringList() << "PawniX" << "--lint" << source << "--include" << libs);
+        QCOMPARE(lint.run(), int(HeadlessRunner::Failed));
+        QJsonArray diagnostics = lint.report()["files"].toArray().first().toObject()["diagnostics"].toArray();
+        QCOMPARE(diagnostics.size(), 1);
+        QCOMPARE(diagnostics.first().toObject()["line"].toInt(), 4);
+        HeadlessRunner build(QStringList() << "PawniX" << "--build" << source << "--compiler" << stubCompiler() << "--include" << libs);
+        QCOMPARE(build.run(), int(HeadlessRunner::Success));
+        QCOMPARE(build.report()["results"].toArray().first().toObject()["lint"].toArray().size(), 1);
+    }
+    void compilerThatCannotStartIsCompilerError() {
+        QString source = writeSource("any.pwn", "main()\n{\n}\n");
+        QString notExecutable = writeSource("pawncc-not-executable", "not a program");
+        QCOMPARE(runBuild(source, notExecutable), int(HeadlessRunner::CompilerError));
+    }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef TST_LINEDIFF_H
+#define TST_LINEDIFF_H
+
+#include <QtTest>
+#include "includes.h"
+#include "gitdiff.h"
+
+class LineDiffTest : public QObject {
+    Q_OBJECT
+private:
+    static QStringList lines(const QString& text) {
+        return text.split(' ');
+    }
+    static QStringList applyHunks(const QStringList& base, const QStringList& current, const QList<DiffHunk>& hunks) {
+        QStringList result;
+        int baseLine = 0;
+        for (const DiffHunk& hunk : hunks) {
+            result << base.mid(baseLine, hunk.baseStart - baseLine) << current.mid(hunk.currentStart, hunk.currentCount);
+            baseLine = hunk.baseStart + hunk.baseCount;
+        }
+        result << base.mid(baseLine);
+        return result;
+    }
+    static void update(LineDiff& diff, const QStringList& current, int first, int oldEnd, int newEnd) {
+        diff.update(first, oldEnd, newEnd, [&current](int from, int to) { return current.mid(from, to - from); });
+    }
+    static void selectLines(QTextCursor& cursor, QTextDocument* document, int fromLine, int toLine) {
+        cursor.setPosition(document->findBlockByNumber(fromLine).position());
+        QTextBlock last = document->findBlockByNumber(toLine);
+        cursor.setPosition(last.position() + last.length() - 1, QTextCursor::KeepAnchor);
+    }
+private slots:
+    void identicalTextHasNoChanges() {
+        LineDiff diff;
+        diff.reset(lines("a b c"), lines("a b c"));
+        QVERIFY(diff.changes().isEmpty());
+    }
+    void modifiedLine() {
+        LineDiff diff;
+        diff.reset(lines("a b c"), lines("a x c"));
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 1, 1, 1, 1 });
+    }
+    void insertedLine() {
+        LineDiff diff;
+        diff.reset(lines("a b"), lines("a n b"));
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 1, 0, 1, 1 });
+    }
+    void deletedLine() {
+        LineDiff diff;
+        diff.reset(lines("a b c"), lines("a c"));
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 1, 1, 1, 0 });
+    }
+    void incrementalUpdates() {
+        QStringList base = lines("a b c d e");
+        QStringList current = base;
+        LineDiff diff;
+        diff.reset(base, current);
+        current[1] = "x";
+        update(diff, current, 1, 2, 2);
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 1, 1, 1, 1 });
+        current.insert(4, "n");
+        current.insert(5, "m");
+        update(diff, current, 3, 4, 6);
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 1, 1, 1, 1 } << DiffHunk { 4, 0, 4, 2 });
+        current[1] = "b";
+        update(diff, current, 1, 2, 2);
+        QCOMPARE(diff.changes(), QList<DiffHunk>() << DiffHunk { 4, 0, 4, 2 });
+        current.remove(4, 2);
+        update(diff, current, 3, 6, 4);
+        QVERIFY(diff.changes().isEmpty());
+    }
+    void trackerFollowsMultiBlockEdits() {
+        CodeEditor editor;
+        editor.setPlainText("a\nb\nc\nd\ne");
+        GitChangeTracker* tracker = GitChangeTracker::forEditor(&editor);
+        tracker->setBaseline(lines("a b c d e"));
+        QVERIFY(tracker->changes().isEmpty());
+        QTextDocument* document = editor.document();
+        QTextCursor cursor(document->findBlockByNumber(1));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.insertText("\nx\ny");
+        QTRY_COMPARE(tracker->changes(), QList<DiffHunk>() << DiffHunk { 2, 0, 2, 2 });
+        cursor.setPosition(document->findBlockByNumber(1).position() + 1);
+        cursor.setPosition(document->findBlockByNumber(4).position() + 1, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        QCOMPARE(document->toPlainText(), QString("a\nb\nd\ne"));
+        QTRY_COMPARE(tracker->changes(), QList<DiffHunk>() << DiffHunk { 2, 1, 2, 0 });
+        selectLines(cursor, document, 1, 2);
+        cursor.insertText("p\nq\nr\ns");
+        QCOMPARE(document->toPlainText(), QString("a\np\nq\nr\ns\ne"));
+        QTRY_COMPARE(tracker->changes(), QList<DiffHunk>() << DiffHunk { 1, 3, 1, 4 });
+        selectLines(cursor, document, 0, 5);
+        cursor.insertText("a\nb\nc\nd\ne");
+        QTRY_VERIFY(tracker->changes().isEmpty());
+        editor.setPlainText("a\nb\nz\nd\ne");
+        QTRY_COMPARE(tracker->changes(), QList<DiffHunk>() << DiffHunk { 2, 1, 2, 1 });
+    }
+    void incrementalUpdatesReproduceDocument() {
+        QRandomGenerator random(20241018);
+        const QStringList alphabet = lines("a b c d e x y z");
+        for (int round = 0; round < 500; ++round) {
+            QStringList base;
+            for (int i = random.bounded(1, 16); i > 0; --i) base << alphabet[random.bounded(5)];
+            QStringList current = base;
+            LineDiff diff;
+            diff.reset(base, current);
+            for (int edit = 0; edit < 6; ++edit) {
+                int line = random.bounded(int(current.size()));
+                int kind = random.bounded(3);
+                if (kind == 0) {
+                    current[line] = alphabet[random.bounded(int(alphabet.size()))];
+                    update(diff, current, line, line + 1, line + 1);
+                } else if (kind == 1) {
+                    int count = random.bounded(1, 4);
+                    for (int i = 0; i < count; ++i) current.insert(line + 1, alphabet[random.bounded(int(alphabet.size()))]);
+                    update(diff, current, line, line + 1, line + 1 + count);
+                } else {
+                    int count = qMin(random.bounded(1, 4), int(current.size()) - 1 - line);
+                    if (count <= 0) continue;
+                    current.remove(line + 1, count);
+                    update(diff, current, line, line + 1 + count, line + 1);
+                }
+                QCOMPARE(applyHunks(base, current, diff.changes()), current);
+            }
+        }
+    }
+};
+
+#endif
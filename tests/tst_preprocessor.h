@@ -0,0 +1,76 @@
+#ifndef TST_PREPROCESSOR_H
+#define TST_PREPROCESSOR_H
+
+#include <QtTest>
+#include "includes.h"
+#include "codeeditor.h"
+
+class PreprocessorTest : public QObject {
+    Q_OBJECT
+private:
+    static bool isInactive(QTextDocument& document, int line) {
+        BlockData* data = static_cast<BlockData*>(document.findBlockByNumber(line).userData());
+        return data && data->inactive;
+    }
+private slots:
+    void continuedDefineKeepsEveryLine() {
+        QTextDocument document;
+        PawnHighlighter highlighter(&document);
+        document.setPlainText("#define HOOK(%0) \\\n"
+                              "    forward %0(); \\\n"
+                              "    public %0()\n"
+                              "HOOK(OnGameModeInit) { return 1; }\n");
+        highlighter.rehighlight();
+        MacroTable macros = highlighter.macrosBefore(document.blockCount());
+        QVERIFY(macros.contains("HOOK"));
+        QCOMPARE(macros["HOOK"].pattern, QString("(%0)"));
+        QCOMPARE(macros["HOOK"].replacement.simplified(), QString("forward %0(); public %0()"));
+        QCOMPARE(macros["HOOK"].line, 2);
+        QVERIFY(!highlighter.macrosBefore(2).contains("HOOK"));
+    }
+    void expandsContinuedMacro() {
+        QTextDocument document;
+        PawnHighlighter highlighter(&document);
+        document.setPlainText("#define HOOK(%0) \\\n"
+                              "    forward %0(); \\\n"
+                              "    public %0()\n");
+        highlighter.rehighlight();
+        int substitutions = 0;
+        QString expanded = MacroExpander(highlighter.macrosBefore(document.blockCount())).expand("HOOK(OnGameModeInit)", &substitutions);
+        QCOMPARE(substitutions, 1);
+        QCOMPARE(expanded.simplified(), QString("forward OnGameModeInit(); public OnGameModeInit()"));
+    }
+    void continuedLinesAreNotDirectives() {
+        PreprocessorState state;
+        LineEffect effect;
+        MacroLookup none = [](const QString&) { return static_cast<const MacroDefinition*>(nullptr); };
+        QVERIFY(PreprocessorModel::processLine(state, u"#define LIMIT \\", none, 0, effect));
+        QVERIFY(effect.event.macro.name.isEmpty());
+        QVERIFY(state.continuation);
+        QVERIFY(PreprocessorModel::processLine(state, u"    (10 + 5)", none, 1, effect));
+        QCOMPARE(effect.event.macro.name, QString("LIMIT"));
+        QCOMPARE(ExpressionEvaluator::evaluate(effect.event.macro.replacement, MacroTable()), qint64(15));
+        QVERIFY(!state.continuation);
+        QVERIFY(state.pendingDefine.isEmpty());
+    }
+    void conditionalFollowsDefineEdit() {
+        QTextDocument document;
+        PawnHighlighter highlighter(&document);
+        document.setPlainText("#define DEBUG 1\n"
+                              "#if DEBUG\n"
+                              "print(\"debug\");\n"
+                              "#endif\n"
+                              "main() {}\n");
+        highlighter.rehighlight();
+        QVERIFY(!isInactive(document, 2));
+        QTextCursor cursor(document.findBlockByNumber(0));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.deletePreviousChar();
+        cursor.insertText("0");
+        QCoreApplication::processEvents();
+        QVERIFY(isInactive(document, 2));
+        QVERIFY(!isInactive(document, 4));
+    }
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "includes.h"
+
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+    bool isRecording() const { return recording.loadRelaxed() != 0; }
+    qint64 now() const { return clock.nsecsElapsed(); }
+    void start() {
+        QMutexLocker locker(&mutex);
+        events.clear();
+        dropped = 0;
+        recording.storeRelaxed(1);
+    }
+    void stop() {
+        recording.storeRelaxed(0);
+    }
+    void addComplete(const char* name, const char* category, qint64 startNs, qint64 durationNs) {
+        if (!isRecording()) return;
+        quint64 thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        QMutexLocker locker(&mutex);
+        if (events.size() >= maxEvents) {
+            ++dropped;
+            return;
+        }
+        events.push_back(Event { name, category, startNs, durationNs, thread });
+    }
+    int eventCount() const {
+        QMutexLocker locker(&mutex);
+        return int(events.size());
+    }
+    QByteArray toChromeJson() const {
+        QMutexLocker locker(&mutex);
+        QByteArray json;
+        json.reserve(int(events.size()) * 96 + 64);
+        json += "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" + QByteArray::number(dropped) + "},\"traceEvents\":[";
+        QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+        QHash<quint64, int> threadIds;
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& event = events[i];
+            int tid = threadIds.value(event.thread, -1);
+            if (tid < 0) {
+                tid = threadIds.size() + 1;
+                threadIds.insert(event.thread, tid);
+            }
+            if (i > 0) json += ',';
+            json += "{\"name\":\"";
+            json += event.name;
+            json += "\",\"cat\":\"";
+            json += event.category;
+            json += "\",\"ph\":\"X\",\"ts\":";
+            json += QByteArray::number(event.startNs / 1000.0, 'f', 3);
+            json += ",\"dur\":";
+            json += QByteArray::number(event.durationNs / 1000.0, 'f', 3);
+            json += ",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(tid) + "}";
+        }
+        json += "]}";
+        return json;
+    }
+private:
+    struct Event {
+        const char* name;
+        const char* category;
+        qint64 startNs;
+        qint64 durationNs;
+        quint64 thread;
+    };
+    static constexpr size_t maxEvents = 2000000;
+    Tracer() { clock.start(); }
+    QAtomicInt recording;
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    std::vector<Event> events;
+    qint64 dropped = 0;
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* eventName, const char* eventCategory)
+        : name(eventName), category(eventCategory),
+          start(Tracer::instance().isRecording() ? Tracer::instance().now() : -1) {}
+    ~TraceScope() {
+        if (start >= 0) {
+            Tracer::instance().addComplete(name, category, start, Tracer::instance().now() - start);
+        }
+    }
+private:
+    const char* name;
+    const char* category;
+    qint64 start;
+};
+
+#define PAWNIX_TRACE_CONCAT_IMPL(a, b) a##b
+#define PAWNIX_TRACE_CONCAT(a, b) PAWNIX_TRACE_CONCAT_IMPL(a, b)
+#define PAWNIX_TRACE(name, category) TraceScope PAWNIX_TRACE_CONCAT(traceScope, __LINE__)(name, category)
+
+class StallDetector : public QObject {
+public:
+    StallDetector(QObject* parent = nullptr) : QObject(parent) {
+        timer.setInterval(interval);
+        connect(&timer, &QTimer::timeout, this, [this]() {
+            qint64 now = Tracer::instance().now();
+            qint64 late = now - lastTick - qint64(interval) * 1000000;
+            if (lastTick > 0 && late > qint64(threshold) * 1000000) {
+                Tracer::instance().addComplete("Event loop stall", "stall", lastTick + qint64(interval) * 1000000, late);
+            }
+            lastTick = now;
+        });
+    }
+    void setActive(bool active) {
+        lastTick = 0;
+        if (active) {
+            timer.start();
+        } else {
+            timer.stop();
+        }
+    }
+private:
+    static constexpr int interval = 20;
+    static constexpr int threshold = 50;
+    QTimer timer;
+    qint64 lastTick = 0;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef WORKSPACEINDEX_H
+#define WORKSPACEINDEX_H
+
+#include "includes.h"
+#include "symbolindex.h"
+#include "sourcefile.h"
+#include "trace.h"
+
+class WorkspaceIndex : public QObject {
+    Q_OBJECT
+public:
+    WorkspaceIndex(QObject* parent = nullptr) : QObject(parent) {
+        connect(&watcher, &QFutureWatcherBase::finished, this, &WorkspaceIndex::merge);
+    }
+    ~WorkspaceIndex() {
+        watcher.waitForFinished();
+    }
+    void indexWorkspace(const QString& folder) {
+        if (folder.isEmpty()) return;
+        if (watcher.isRunning()) {
+            queuedRoot = folder;
+            return;
+        }
+        QString scanRoot = QFileInfo(folder).absoluteFilePath();
+        bool switched = !root.isEmpty() && scanRoot != root;
+        root = scanRoot;
+        QHash<QString, QDateTime> known = stamps;
+        QSet<QString> skip = live;
+        watcher.setFuture(QtConcurrent::run([scanRoot, switched, known, skip]() {
+            PAWNIX_TRACE("indexWorkspace", "index");
+            Scan scan;
+            scan.switched = switched;
+            scan.files = SymbolIndex::workspaceFiles(scanRoot);
+            QStringList changed;
+            for (const QString& file : scan.files) {
+                if (!skip.contains(file) && known.value(file) != QFileInfo(file).lastModified()) changed << file;
+            }
+            scan.parsed = QtConcurrent::blockingMapped(changed, &WorkspaceIndex::parseFile);
+            return scan;
+        }));
+    }
+    void updateFile(const QString& filePath, const QList<SymbolInfo>& fileSymbols, const FileReferences& references) {
+        PAWNIX_TRACE("updateIndex", "index");
+        live.insert(filePath);
+        stamps.remove(filePath);
+        symbols.update(filePath, fileSymbols);
+        referenceIndex.update(filePath, references);
+    }
+    void releaseFile(const QString& filePath) {
+        if (!live.remove(filePath)) return;
+        FileData data = parseFile(filePath);
+        if (!data.valid) {
+            symbols.remove(filePath);
+            referenceIndex.remove(filePath);
+            return;
+        }
+        store(data);
+    }
+    QList<SymbolInfo> definitions(const QString& name) const {
+        QList<SymbolInfo> all = symbols.find(name);
+        QList<SymbolInfo> defined;
+        for (const SymbolInfo& symbol : all) {
+            if (symbol.definition) defined.append(symbol);
+        }
+        return defined.isEmpty() ? all : defined;
+    }
+    QList<SymbolReference> references(const QString& name) const {
+        return referenceIndex.references(name);
+    }
+    QList<SymbolInfo> outline(const QString& filePath) const {
+        QList<SymbolInfo> result;
+        for (const SymbolInfo& symbol : symbols.symbolsInFile(filePath)) {
+            if (symbol.isFunction() && symbol.definition) result.append(symbol);
+        }
+        return result;
+    }
+    const SymbolIndex& symbolIndex() const { return symbols; }
+    bool isIndexing() const { return watcher.isRunning(); }
+signals:
+    void indexed(int fileCount, int changedCount);
+private:
+    struct FileData {
+        QString file;
+        QDateTime modified;
+        QList<SymbolInfo> symbols;
+        FileReferences references;
+        bool valid = false;
+    };
+    struct Scan {
+        QStringList files;
+        QList<FileData> parsed;
+        bool switched = false;
+    };
+    QString root;
+    QString queuedRoot;
+    SymbolIndex symbols;
+    ReferenceIndex referenceIndex;
+    QHash<QString, QDateTime> stamps;
+    QSet<QString> live;
+    QFutureWatcher<Scan> watcher;
+
+    static FileData parseFile(const QString& filePath) {
+        FileData data;
+        data.file = filePath;
+        data.modified = QFileInfo(filePath).lastModified();
+        QString text;
+        if (!SourceFile::read(filePath, text)) return data;
+        data.symbols = SymbolParser::parse(text, filePath);
+        data.references = ReferenceIndex::scan(text);
+        data.valid = true;
+        return data;
+    }
+    void store(const FileData& data) {
+        symbols.update(data.file, data.symbols);
+        referenceIndex.update(data.file, data.references);
+        stamps.insert(data.file, data.modified);
+    }
+    void merge() {
+        PAWNIX_TRACE("mergeIndex", "index");
+        Scan scan = watcher.result();
+        QSet<QString> present(scan.files.begin(), scan.files.end());
+        QString prefix = root + '/';
+        for (const QString& file : symbols.files()) {
+            if ((scan.switched || file.startsWith(prefix)) && !present.contains(file) && !live.contains(file)) {
+                symbols.remove(file);
+                referenceIndex.remove(file);
+                stamps.remove(file);
+            }
+        }
+        for (const FileData& data : scan.parsed) {
+            if (data.valid && !live.contains(data.file)) store(data);
+        }
+        emit indexed(symbols.fileCount(), scan.parsed.size());
+        if (!queuedRoot.isEmpty()) {
+            QString next = queuedRoot;
+            queuedRoot.clear();
+            indexWorkspace(next);
+        }
+    }
+};
+
+#endif